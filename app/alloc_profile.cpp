@@ -0,0 +1,85 @@
+// The replacement global operator new and operator delete of the
+// allocation profiler (see ra/alloc_profile.hpp). This file is only
+// linked into the programs when the profiler is enabled (i.e., when
+// configured with -DRA_ALLOC_PROFILE=ON).
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include"ra/alloc_profile.hpp"
+
+#if RA_ALLOC_PROFILE
+
+namespace {
+	// The header stored before each block: the pointer returned by
+	// malloc, and the region to which the allocation was attributed (so
+	// that the deallocation is attributed to it as well).
+	struct Header {
+		void* base;
+		ra::profile::Region region;
+	};
+
+	// The alignment of the blocks of the unaligned forms of operator new.
+	constexpr std::size_t default_alignment = alignof(std::max_align_t);
+
+	void* allocate(std::size_t size, std::size_t alignment){
+		ra::profile::Region region = ra::profile::record_allocation(size);
+		if(alignment < default_alignment){ alignment = default_alignment; }
+		// The header is placed just before the block, whose start is
+		// rounded up to the alignment.
+		std::size_t padding = sizeof(Header) + alignment - 1;
+		if(size > std::size_t(-1) - padding){ throw std::bad_alloc(); }
+		while(true){
+			if(void* base = std::malloc(size + padding)){
+				std::uintptr_t start = (reinterpret_cast<std::uintptr_t>(base) + sizeof(Header) + alignment - 1) & ~std::uintptr_t(alignment - 1);
+				Header* header = reinterpret_cast<Header*>(start) - 1;
+				header->base = base;
+				header->region = region;
+				return reinterpret_cast<void*>(start);
+			}
+			std::new_handler handler = std::get_new_handler();
+			if(!handler){ throw std::bad_alloc(); }
+			handler();
+		}
+	}
+
+	void* allocate(std::size_t size, std::size_t alignment, const std::nothrow_t&) noexcept {
+		try{
+			return allocate(size, alignment);
+		}
+		catch(const std::bad_alloc&){
+			return nullptr;
+		}
+	}
+
+	void deallocate(void* p) noexcept {
+		if(p){
+			Header* header = static_cast<Header*>(p) - 1;
+			ra::profile::record_deallocation(header->region);
+			std::free(header->base);
+		}
+	}
+}
+
+void* operator new(std::size_t size){ return allocate(size, default_alignment); }
+void* operator new[](std::size_t size){ return allocate(size, default_alignment); }
+void* operator new(std::size_t size, const std::nothrow_t& tag) noexcept { return allocate(size, default_alignment, tag); }
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return allocate(size, default_alignment, tag); }
+void* operator new(std::size_t size, std::align_val_t alignment){ return allocate(size, std::size_t(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment){ return allocate(size, std::size_t(alignment)); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept { return allocate(size, std::size_t(alignment), tag); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept { return allocate(size, std::size_t(alignment), tag); }
+void operator delete(void* p) noexcept { deallocate(p); }
+void operator delete[](void* p) noexcept { deallocate(p); }
+void operator delete(void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { deallocate(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { deallocate(p); }
+void operator delete(void* p, std::align_val_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { deallocate(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { deallocate(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(p); }
+
+#endif
@@ -0,0 +1,306 @@
+#include<iostream>
+#include<fstream>
+#include<sstream>
+#include<string>
+#include<vector>
+#include<array>
+#include<random>
+#include<chrono>
+#include<algorithm>
+#include<thread>
+#include<cstdint>
+#include<cstdlib>
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Triangulation_vertex_base_with_info_2.h>
+#include <CGAL/Triangulation_data_structure_2.h>
+#include <CGAL/Triangulation_2.h>
+#include <CGAL/Delaunay_triangulation_2.h>
+#include <CGAL/Simple_cartesian.h>
+#include"ra/kernel.hpp"
+#include"triangulation_2.hpp"
+#include"pd_delaunay.hpp"
+#include"dc_delaunay.hpp"
+#include"perf_counters.hpp"
+
+// A differential harness comparing the LOP of delaunay_triangulation
+// with CGAL's Delaunay_triangulation_2.
+// For random point sets, a reference Delaunay triangulation is built with
+// CGAL, and the LOP is run from several starting triangulations of the
+// same points. Wherever the Delaunay triangulation is unique (i.e., no
+// four points of adjacent faces are cocircular), the preferred-directions
+// Delaunay triangulation is the Delaunay triangulation, so the results
+// must agree with the reference. The same holds for the divide-and-conquer
+// construction, which is run with each of the given numbers of threads.
+// The wall time, flips, predicate counts and peak memory of each run are
+// reported side by side. With --counters, the hardware performance
+// counters of the load are reported per vertex, and those of the LOP per
+// tested edge.
+
+using Epick = CGAL::Exact_predicates_inexact_constructions_kernel;
+using Vb = CGAL::Triangulation_vertex_base_with_info_2<int, Epick>;
+using Tds = CGAL::Triangulation_data_structure_2<Vb>;
+using Cgal_delaunay = CGAL::Delaunay_triangulation_2<Epick, Tds>;
+using Cgal_triangulation = CGAL::Triangulation_2<Epick, Tds>;
+using Cgal_point = Epick::Point_2;
+
+using Kernel = CGAL::Simple_cartesian<double>;
+using kernel = ra::geometry::Kernel<double>;
+using Triangulation = trilib::Triangulation_2<Kernel>;
+using Directions = ra::geometry::Pd_directions<1,0,1,1>;
+
+// A triangle given by the input indices of its vertices, rotated so that
+// the smallest index is first.
+using Triangle = std::array<int,3>;
+
+Triangle make_triangle(int a, int b, int c){
+	if( (b < a) && (b < c) ){ return Triangle{b,c,a}; }
+	else if( (c < a) && (c < b) ){ return Triangle{c,a,b}; }
+	else{ return Triangle{a,b,c}; }
+}
+
+// Reads a field (in kB) of /proc/self/status, or returns -1.
+long read_status_kb(const std::string& field){
+	std::ifstream in("/proc/self/status");
+	std::string line;
+	while(std::getline(in, line)){
+		if(line.compare(0, field.size() + 1, field + ":") == 0){ return std::atol(line.c_str() + field.size() + 1); }
+	}
+	return -1;
+}
+
+// Measures the peak memory of a phase of the harness. The peak resident
+// set size of the process is reset to the current size at the start of
+// the phase, so phases are measured independently of each other.
+class Memory_probe {
+	public:
+		Memory_probe() {
+			std::ofstream("/proc/self/clear_refs")<<"5";
+			start_kb_ = read_status_kb("VmRSS");
+		}
+		// Get the growth of the peak resident set size since the start of
+		// the phase, or -1 if it is not available.
+		long peak_kb() const {
+			long peak = read_status_kb("VmHWM");
+			return ( (peak < 0) || (start_kb_ < 0) ) ? -1 : std::max(0L, peak - start_kb_);
+		}
+	private:
+		long start_kb_;
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::vector<Cgal_point> make_points(int n, const std::string& distribution, unsigned seed){
+	std::mt19937_64 gen(seed);
+	std::vector<Cgal_point> points;
+	points.reserve(n);
+	if(distribution == "gaussian"){
+		std::normal_distribution<double> coord(0.0, 1.0);
+		for(int i = 0; i < n; ++i){ points.push_back(Cgal_point(coord(gen), coord(gen))); }
+	}
+	else{
+		std::uniform_real_distribution<double> coord(0.0, 1.0);
+		for(int i = 0; i < n; ++i){ points.push_back(Cgal_point(coord(gen), coord(gen))); }
+	}
+	return points;
+}
+
+template<class Tri>
+std::vector<Triangle> cgal_triangles(const Tri& tri){
+	std::vector<Triangle> result;
+	for(auto f = tri.finite_faces_begin(); f != tri.finite_faces_end(); ++f){
+		result.push_back(make_triangle(f->vertex(0)->info(), f->vertex(1)->info(), f->vertex(2)->info()));
+	}
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+std::vector<Triangle> our_triangles(const Triangulation& tri){
+	std::vector<Triangle> result;
+	for(auto f = tri.faces_begin(); f != tri.faces_end(); ++f){
+		auto h = f->halfedge();
+		result.push_back(make_triangle(h->vertex()->id(), h->next()->vertex()->id(), h->next()->next()->vertex()->id()));
+	}
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+// Tests if the Delaunay triangulation is unique, i.e., if no edge of the
+// reference has its four surrounding points on a common circle.
+bool is_unique_delaunay(const Cgal_delaunay& dt, const kernel& obj){
+	using point = kernel::Point;
+	for(auto e = dt.finite_edges_begin(); e != dt.finite_edges_end(); ++e){
+		auto f = e->first;
+		int i = e->second;
+		auto g = f->neighbor(i);
+		if(dt.is_infinite(f) || dt.is_infinite(g)){ continue; }
+		auto to_point = [](const Cgal_point& p){ return point(p.x(), p.y()); };
+		const Cgal_point& a = f->vertex(f->ccw(i))->point();
+		const Cgal_point& b = f->vertex(f->cw(i))->point();
+		const Cgal_point& c = f->vertex(i)->point();
+		const Cgal_point& d = g->vertex(g->index(f))->point();
+		if(obj.side_of_oriented_circle(to_point(a), to_point(b), to_point(c), to_point(d)) == kernel::Oriented_side::on_boundary){
+			return false;
+		}
+	}
+	return true;
+}
+
+// Converts a triangulation of the points (with the info of each vertex
+// being its index) to the binary format of Triangulation_2.
+template<class Tri>
+std::string to_binary(const Tri& tri, const std::vector<Cgal_point>& points){
+	std::vector<std::int32_t> faces;
+	for(auto f = tri.finite_faces_begin(); f != tri.finite_faces_end(); ++f){
+		for(int j = 0; j < 3; ++j){ faces.push_back(f->vertex(j)->info()); }
+	}
+	std::int32_t counts[2] = {std::int32_t(points.size()), std::int32_t(faces.size() / 3)};
+	std::string result("BTRI");
+	result.append(reinterpret_cast<const char*>(counts), sizeof(counts));
+	for(const Cgal_point& p : points){
+		double coords[2] = {p.x(), p.y()};
+		result.append(reinterpret_cast<const char*>(coords), sizeof(coords));
+	}
+	result.append(reinterpret_cast<const char*>(faces.data()), faces.size() * sizeof(std::int32_t));
+	return result;
+}
+
+// Builds a (generally non-Delaunay) triangulation of the points by
+// inserting them in the given order.
+std::string make_start(const std::vector<Cgal_point>& points, const std::vector<int>& order){
+	Cgal_triangulation tri;
+	Cgal_triangulation::Face_handle hint;
+	for(int i : order){
+		Cgal_triangulation::Vertex_handle v = tri.insert(points[i], hint);
+		v->info() = i;
+		hint = v->face();
+	}
+	return to_binary(tri, points);
+}
+
+// Runs the LOP from a starting triangulation and reports the result.
+// The counters (if not null) are read around the load and the LOP.
+bool run_lop(const std::string& name, const std::string& start, const std::vector<Triangle>& reference, bool unique,
+  trilib::perf::Counters* counters){
+	kernel obj;
+	Memory_probe memory;
+	auto begin = std::chrono::steady_clock::now();
+	Triangulation tri;
+	std::istringstream in(start);
+	if(counters){ counters->start(); }
+	if(!tri.input_binary(in)){
+		std::cout<<name<<" failed to load\n";
+		return false;
+	}
+	trilib::perf::Sample load_sample = counters ? counters->stop() : trilib::perf::Sample{};
+	double load_time = seconds_since(begin);
+	kernel::clear_statistics();
+	begin = std::chrono::steady_clock::now();
+	if(counters){ counters->start(); }
+	trilib::Lop_statistics lop = trilib::pd_delaunay_lop(tri, obj, Directions::u, Directions::v);
+	trilib::perf::Sample lop_sample = counters ? counters->stop() : trilib::perf::Sample{};
+	double lop_time = seconds_since(begin);
+	kernel::Statistics st;
+	kernel::get_statistics(st);
+	bool agree = (our_triangles(tri) == reference);
+	std::cout<<name<<" load="<<load_time<<"s lop="<<lop_time<<"s flips="<<lop.flip_count
+	  <<" orient="<<st.orientation_total_count<<" incircle="<<st.side_of_oriented_circle_total_count
+	  <<" pd_edge="<<st.locally_pd_delaunay_edge_total_count<<" exact="<<st.locally_pd_delaunay_edge_exact_count
+	  <<" peak_kb="<<memory.peak_kb()<<" agree="<<(unique ? (agree ? "yes" : "NO") : "n/a")<<"\n";
+	if(counters){
+		std::cout<<name<<" load_counters:"<<trilib::perf::format_per_operation(load_sample, tri.size_of_vertices())<<"\n";
+		std::cout<<name<<" lop_counters:"<<trilib::perf::format_per_operation(lop_sample, lop.test_count)<<"\n";
+	}
+	return agree || !unique;
+}
+
+// Builds the triangulation of the points by divide and conquer and
+// reports the result.
+bool run_dc(const std::vector<Cgal_point>& points, const std::vector<Triangle>& reference, bool unique, int num_threads,
+  trilib::perf::Counters* counters){
+	kernel obj;
+	std::vector<double> coordinates;
+	coordinates.reserve(2 * points.size());
+	for(const Cgal_point& p : points){ coordinates.insert(coordinates.end(), {p.x(), p.y()}); }
+	Memory_probe memory;
+	auto begin = std::chrono::steady_clock::now();
+	Triangulation tri;
+	tri.set_validation(Triangulation::Validation::trusted);
+	if(counters){ counters->start(); }
+	trilib::Lop_statistics lop{0,0,0};
+	if(!trilib::dc_pd_delaunay(tri, obj, Directions::u, Directions::v, coordinates.data(), int(points.size()), num_threads, &lop)){
+		std::cout<<"dc-pd-delaunay failed\n";
+		return false;
+	}
+	trilib::perf::Sample sample = counters ? counters->stop() : trilib::perf::Sample{};
+	double dc_time = seconds_since(begin);
+	bool agree = (our_triangles(tri) == reference);
+	std::cout<<"dc-pd-delaunay threads="<<num_threads<<" build="<<dc_time<<"s flips="<<lop.flip_count
+	  <<" peak_kb="<<memory.peak_kb()<<" agree="<<(unique ? (agree ? "yes" : "NO") : "n/a")<<"\n";
+	if(counters){ std::cout<<"dc-pd-delaunay build_counters:"<<trilib::perf::format_per_operation(sample, points.size())<<"\n"; }
+	return agree || !unique;
+}
+
+void usage(){
+	std::cerr<<"usage: bench_cgal [--points n]... [--distribution uniform|gaussian] [--seed s] [--threads n]... [--counters]\n";
+}
+
+int main(int argc, char** argv){
+	std::vector<int> sizes;
+	std::string distribution("uniform");
+	unsigned seed = 1;
+	bool use_counters = false;
+	std::vector<int> thread_counts;
+	for(int i = 1; i < argc; ++i){
+		std::string arg(argv[i]);
+		if( (arg == "--points") && (i+1 < argc) ){ sizes.push_back(std::atoi(argv[++i])); }
+		else if( (arg == "--distribution") && (i+1 < argc) ){ distribution = argv[++i]; }
+		else if( (arg == "--seed") && (i+1 < argc) ){ seed = std::atoi(argv[++i]); }
+		else if(arg == "--counters"){ use_counters = true; }
+		else if( (arg == "--threads") && (i+1 < argc) ){ thread_counts.push_back(std::max(1, std::atoi(argv[++i]))); }
+		else{ usage(); return 2; }
+	}
+	if(sizes.empty()){ sizes = {10000, 100000}; }
+	if(thread_counts.empty()){ thread_counts = {1, int(std::max(1u, std::thread::hardware_concurrency()))}; }
+
+	trilib::perf::Counters counters;
+	if(use_counters && !counters.available()){ std::cerr<<"hardware performance counters are not available\n"; }
+	trilib::perf::Counters* probe = use_counters ? &counters : nullptr;
+
+	bool ok = true;
+	kernel obj;
+	for(int n : sizes){
+		std::vector<Cgal_point> points = make_points(n, distribution, seed);
+		std::vector<std::pair<Cgal_point,int>> indexed;
+		for(int i = 0; i < n; ++i){ indexed.push_back(std::make_pair(points[i], i)); }
+
+		Memory_probe memory;
+		auto begin = std::chrono::steady_clock::now();
+		Cgal_delaunay dt;
+		if(probe){ probe->start(); }
+		dt.insert(indexed.begin(), indexed.end());
+		trilib::perf::Sample cgal_sample = probe ? probe->stop() : trilib::perf::Sample{};
+		double cgal_time = seconds_since(begin);
+		long cgal_peak = memory.peak_kb();
+		std::vector<Triangle> reference = cgal_triangles(dt);
+		bool unique = is_unique_delaunay(dt, obj);
+		std::cout<<"points="<<n<<" distribution="<<distribution<<" faces="<<reference.size()<<" unique="<<(unique ? "yes" : "no")<<"\n";
+		std::cout<<"cgal-delaunay build="<<cgal_time<<"s peak_kb="<<cgal_peak<<"\n";
+		if(probe){ std::cout<<"cgal-delaunay build_counters:"<<trilib::perf::format_per_operation(cgal_sample, n)<<"\n"; }
+
+		for(int num_threads : thread_counts){ ok = run_dc(points, reference, unique, num_threads, probe) && ok; }
+
+		std::vector<int> order(n);
+		for(int i = 0; i < n; ++i){ order[i] = i; }
+		std::mt19937_64 order_gen(seed);
+		std::shuffle(order.begin(), order.end(), order_gen);
+		std::string from_delaunay = to_binary(dt, points);
+		dt.clear();
+		ok = run_lop("lop-from-delaunay", from_delaunay, reference, unique, probe) && ok;
+		ok = run_lop("lop-from-random-insertion", make_start(points, order), reference, unique, probe) && ok;
+		std::sort(order.begin(), order.end(), [&points](int i, int j){ return points[i] < points[j]; });
+		ok = run_lop("lop-from-sorted-insertion", make_start(points, order), reference, unique, probe) && ok;
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+#include<iostream>
+#include<fstream>
+#include<sstream>
+#include<string>
+#include<vector>
+#include<chrono>
+#include<cstdlib>
+#include<filesystem>
+#include <CGAL/Simple_cartesian.h>
+#include"triangulation_2.hpp"
+#include"compressed_io.hpp"
+#include"mesh_generator.hpp"
+
+// Compares the throughput of reading and writing meshes uncompressed and
+// compressed (see compressed_io.hpp), in OFF and binary formats.
+// For each generated mesh and format, the mesh is first written and read
+// directly (without the streams of compressed_io.hpp), and then through
+// the streams with each compression. The throughputs are those of the
+// uncompressed data, in MB/s, and the reads include building the
+// triangulation (with trusted validation). By default, the data is kept in
+// memory; with --dir, it is written to and read from files in a directory
+// (e.g., on network storage). The meshes are jittered grids (see
+// mesh_generator.hpp).
+
+using Kernel = CGAL::Simple_cartesian<double>;
+using Triangulation = trilib::Triangulation_2<Kernel>;
+using trilib::io::Compression;
+
+double seconds_since(std::chrono::steady_clock::time_point start){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool write_mesh(const Triangulation& tri, bool binary, std::ostream& out){
+	return binary ? tri.output_binary(out) : tri.output_off(out);
+}
+
+bool read_mesh(Triangulation& tri, bool binary, std::istream& in){
+	tri.set_validation(trilib::Validation::trusted);
+	return binary ? tri.input_binary(in) : tri.input_off(in);
+}
+
+// Writes and reads the mesh with a compression (or directly, if direct),
+// and reports the throughputs relative to raw_size bytes of uncompressed
+// data. The data is kept in memory if path is empty.
+bool run_io(const Triangulation& tri, bool binary, bool direct, Compression compression, int level, double raw_size,
+  const std::filesystem::path& path){
+	std::ostringstream memory_out;
+	std::ofstream file_out;
+	if(!path.empty()){ file_out.open(path, std::ios::binary); }
+	std::ostream& sink = path.empty() ? static_cast<std::ostream&>(memory_out) : static_cast<std::ostream&>(file_out);
+	auto start = std::chrono::steady_clock::now();
+	bool ok;
+	if(direct){
+		ok = write_mesh(tri, binary, sink) && bool(sink.flush());
+	}
+	else{
+		trilib::io::Output_stream out(sink, compression, level);
+		ok = write_mesh(tri, binary, out) && out.close();
+	}
+	double write_seconds = seconds_since(start);
+	if(!path.empty()){ file_out.close(); }
+	std::string data = path.empty() ? memory_out.str() : std::string();
+	double size = path.empty() ? double(data.size()) : double(std::filesystem::file_size(path));
+
+	std::istringstream memory_in(data);
+	std::ifstream file_in;
+	if(!path.empty()){ file_in.open(path, std::ios::binary); }
+	std::istream& source = path.empty() ? static_cast<std::istream&>(memory_in) : static_cast<std::istream&>(file_in);
+	Triangulation result;
+	start = std::chrono::steady_clock::now();
+	if(direct){
+		ok = read_mesh(result, binary, source) && ok;
+	}
+	else{
+		trilib::io::Input_stream in(source);
+		ok = read_mesh(result, binary, in) && (in.compression() == compression) && ok;
+	}
+	double read_seconds = seconds_since(start);
+	ok = ok && (result.size_of_faces() == tri.size_of_faces());
+
+	std::cout<<(binary ? "binary" : "off")<<" "<<(direct ? "direct" : trilib::io::compression_name(compression));
+	if(!direct && (compression != Compression::none)){ std::cout<<" level="<<((level > 0) ? std::to_string(level) : std::string("default")); }
+	std::cout<<" bytes="<<std::size_t(size)<<" ratio="<<(raw_size / size)<<" write="<<(raw_size / write_seconds / 1e6)<<"MB/s"
+	  <<" read="<<(raw_size / read_seconds / 1e6)<<"MB/s"<<(ok ? "" : " FAILED")<<"\n";
+	return ok;
+}
+
+void usage(){
+	std::cerr<<"usage: bench_io [--size n]... [--seed s] [--compress none|gzip|zstd]... [--level n]... [--dir directory]\n"
+	  <<"       (each level must be valid for each compression: 1-9 for gzip, 1-19 for zstd, 0 for the default)\n";
+}
+
+int main(int argc, char** argv){
+	std::vector<int> sizes;
+	std::vector<Compression> compressions;
+	std::vector<std::string> level_texts;
+	unsigned seed = 1;
+	std::filesystem::path dir;
+	for(int i = 1; i < argc; ++i){
+		std::string arg(argv[i]);
+		Compression compression;
+		if( (arg == "--size") && (i+1 < argc) ){ sizes.push_back(std::atoi(argv[++i])); }
+		else if( (arg == "--seed") && (i+1 < argc) ){ seed = std::atoi(argv[++i]); }
+		else if( (arg == "--compress") && (i+1 < argc) && trilib::io::parse_compression(argv[++i], compression) ){
+			compressions.push_back(compression);
+		}
+		else if( (arg == "--level") && (i+1 < argc) ){ level_texts.push_back(argv[++i]); }
+		else if( (arg == "--dir") && (i+1 < argc) ){ dir = argv[++i]; }
+		else{ usage(); return 2; }
+	}
+	if(sizes.empty()){ sizes = {300}; }
+	if(compressions.empty()){ compressions = {Compression::none, Compression::gzip, Compression::zstd}; }
+	if(level_texts.empty()){ level_texts = {"1", "0"}; }
+	// Every level must be valid for every compressed format.
+	std::vector<int> levels;
+	for(const std::string& text : level_texts){
+		int level = 0;
+		for(Compression compression : compressions){
+			if( (compression != Compression::none) && !trilib::io::parse_compression_level(text, compression, level) ){
+				std::cerr<<"the compression level of "<<trilib::io::compression_name(compression)<<" is from 1 to "
+				  <<trilib::io::max_compression_level(compression)<<" (or 0 for the default)\n";
+				return 2;
+			}
+		}
+		levels.push_back(level);
+	}
+
+	bool ok = true;
+	for(int n : sizes){
+		Triangulation tri;
+		trilib::generator::Mesh mesh = trilib::generator::make_grid_mesh(n, 0.2, seed);
+		if(!tri.input_arrays(mesh.coordinates.data(), mesh.num_vertices(), mesh.faces.data(), mesh.num_faces())){
+			std::cout<<"size="<<n<<" failed to build\n";
+			ok = false;
+			continue;
+		}
+		std::cout<<"size="<<n<<" vertices="<<tri.size_of_vertices()<<" faces="<<tri.size_of_faces()<<"\n";
+		for(bool binary : {false, true}){
+			std::ostringstream raw;
+			write_mesh(tri, binary, raw);
+			double raw_size = double(raw.str().size());
+			std::filesystem::path path;
+			if(!dir.empty()){ path = dir / (std::string("bench_io.") + (binary ? "bin" : "off")); }
+			ok = run_io(tri, binary, true, Compression::none, 0, raw_size, path) && ok;
+			for(Compression compression : compressions){
+				if(!trilib::io::is_available(compression)){
+					std::cout<<(binary ? "binary" : "off")<<" "<<trilib::io::compression_name(compression)<<" not available\n";
+					continue;
+				}
+				if(compression == Compression::none){
+					ok = run_io(tri, binary, false, compression, 0, raw_size, path) && ok;
+					continue;
+				}
+				for(int level : levels){ ok = run_io(tri, binary, false, compression, level, raw_size, path) && ok; }
+			}
+			if(!path.empty()){ std::filesystem::remove(path); }
+		}
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+#include<iostream>
+#include<string>
+#include<vector>
+#include<array>
+#include<chrono>
+#include<cstdlib>
+#include <CGAL/Simple_cartesian.h>
+#include"ra/kernel.hpp"
+#include"ra/alloc_profile.hpp"
+#include"triangulation_2.hpp"
+#include"pd_delaunay.hpp"
+#include"perf_counters.hpp"
+#include"mesh_generator.hpp"
+
+// Compares the schedules of the LOP of delaunay_triangulation.
+// For each generated mesh (random points swept into long and thin faces,
+// so that the flips interact; see mesh_generator.hpp), the LOP is run once
+// with each schedule, and the wall time, flips, tested edges and predicate
+// counts are reported side by side. Since the preferred-directions
+// Delaunay triangulation is unique, every schedule must give the same
+// faces. With --counters, the
+// hardware performance counters of the LOP are reported per tested edge.
+// The preferred directions are compile-time constants, as in
+// delaunay_triangulation, unless --runtime-directions is given (to
+// measure the cost of the generic tie-break). With --vertex-cache, the
+// vertices cache their lifted coordinates and filter bounds (computed
+// while loading the mesh, outside of the timed LOP), and the number of
+// tests decided by the semi-static filter is reported.
+
+using Kernel = CGAL::Simple_cartesian<double>;
+using kernel = ra::geometry::Kernel<double>;
+using Triangulation = trilib::Triangulation_2<Kernel>;
+// A triangulation whose vertices cache their kernel values (see --vertex-cache).
+using Cached_triangulation = trilib::Triangulation_2<Kernel, true>;
+using vector = CGAL::Simple_cartesian<double>::Vector_2;
+using Directions = ra::geometry::Pd_directions<1,0,1,1>;
+
+double seconds_since(std::chrono::steady_clock::time_point start){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Runs the LOP on the mesh with a schedule and reports the result, whose
+// sorted faces are stored in result. The counters (if not null) are read
+// around the LOP.
+template<class Tri>
+bool run_lop(const trilib::generator::Mesh& mesh, trilib::Schedule schedule, bool runtime_directions,
+  std::vector<std::array<int,3>>& result, trilib::perf::Counters* counters){
+	kernel obj;
+	Tri tri;
+	if(!tri.input_arrays(mesh.coordinates.data(), mesh.num_vertices(), mesh.faces.data(), mesh.num_faces())){
+		std::cout<<trilib::schedule_name(schedule)<<" failed to load\n";
+		return false;
+	}
+	kernel::clear_statistics();
+	ra::profile::clear_statistics();
+	auto begin = std::chrono::steady_clock::now();
+	if(counters){ counters->start(); }
+	trilib::Lop_statistics lop = runtime_directions ? trilib::pd_delaunay_lop(tri, obj, vector(1,0), vector(1,1), schedule) :
+	  trilib::pd_delaunay_lop(tri, obj, Directions::u, Directions::v, schedule);
+	trilib::perf::Sample sample = counters ? counters->stop() : trilib::perf::Sample{};
+	double lop_time = seconds_since(begin);
+	kernel::Statistics st;
+	kernel::get_statistics(st);
+	ra::profile::Allocation_statistics alloc_stat;
+	ra::profile::get_statistics(alloc_stat);
+	result = trilib::generator::sorted_faces(tri);
+	std::cout<<trilib::schedule_name(schedule)<<" lop="<<lop_time<<"s flips="<<lop.flip_count<<" tests="<<lop.test_count
+	  <<" suspects="<<lop.suspect_push_count<<" fq="<<st.flippable_quad_total_count<<" fq_ex="<<st.flippable_quad_exact_count
+	  <<" pd_edge="<<st.locally_pd_delaunay_edge_total_count<<" pd_edge_ex="<<st.locally_pd_delaunay_edge_exact_count
+	  <<" ties="<<st.locally_pd_delaunay_edge_tie_count;
+	if(Tri::vertex_cache()){ std::cout<<" fq_semi="<<st.flippable_quad_semi_static_count; }
+	if(counters){ std::cout<<trilib::perf::format_per_operation(sample, lop.test_count); }
+	std::cout<<"\n";
+	if(ra::profile::enabled){ ra::profile::print_statistics(std::cout, alloc_stat); }
+	return true;
+}
+
+void usage(){
+	std::cerr<<"usage: bench_schedule [--size n]... [--seed s] [--schedule lifo|fifo|spatial|priority]... [--counters] [--runtime-directions] [--vertex-cache]\n";
+}
+
+int main(int argc, char** argv){
+	std::vector<int> sizes;
+	std::vector<trilib::Schedule> schedules;
+	unsigned seed = 1;
+	bool use_counters = false;
+	bool runtime_directions = false;
+	bool vertex_cache = false;
+	for(int i = 1; i < argc; ++i){
+		std::string arg(argv[i]);
+		trilib::Schedule schedule;
+		if( (arg == "--size") && (i+1 < argc) ){ sizes.push_back(std::atoi(argv[++i])); }
+		else if( (arg == "--seed") && (i+1 < argc) ){ seed = std::atoi(argv[++i]); }
+		else if(arg == "--counters"){ use_counters = true; }
+		else if(arg == "--runtime-directions"){ runtime_directions = true; }
+		else if(arg == "--vertex-cache"){ vertex_cache = true; }
+		else if( (arg == "--schedule") && (i+1 < argc) && trilib::parse_schedule(argv[++i], schedule) ){ schedules.push_back(schedule); }
+		else{ usage(); return 2; }
+	}
+	if(sizes.empty()){ sizes = {10000, 100000}; }
+	if(schedules.empty()){ schedules = {trilib::Schedule::lifo, trilib::Schedule::fifo, trilib::Schedule::spatial, trilib::Schedule::priority}; }
+
+	trilib::perf::Counters counters;
+	if(use_counters && !counters.available()){ std::cerr<<"hardware performance counters are not available\n"; }
+
+	bool ok = true;
+	for(int n : sizes){
+		trilib::generator::Mesh mesh = trilib::generator::make_sweep_mesh(n, seed);
+		std::cout<<"size="<<n<<" vertices="<<mesh.num_vertices()<<"\n";
+		std::vector<std::array<int,3>> reference;
+		for(trilib::Schedule schedule : schedules){
+			std::vector<std::array<int,3>> result;
+			bool loaded = vertex_cache ? run_lop<Cached_triangulation>(mesh, schedule, runtime_directions, result, use_counters ? &counters : nullptr) :
+			  run_lop<Triangulation>(mesh, schedule, runtime_directions, result, use_counters ? &counters : nullptr);
+			if(!loaded){
+				ok = false;
+				continue;
+			}
+			if(reference.empty()){ reference = result; }
+			else if(result != reference){
+				std::cout<<trilib::schedule_name(schedule)<<" DISAGREES\n";
+				ok = false;
+			}
+		}
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+#include<iostream>
+#include<sstream>
+#include<string>
+#include<vector>
+#include<chrono>
+#include<algorithm>
+#include<cstdint>
+#include<cstdlib>
+#include<limits>
+#include"service.hpp"
+#include"mesh_generator.hpp"
+
+// Measures the latency of the service mode of delaunay_triangulation.
+// For each mesh size, the same mesh is sent repeatedly over one
+// connection, and the 50th and 99th percentiles of the round-trip time
+// (and of the time spent by the server) are reported. The meshes are grids
+// of integer points, with each cell split along a random diagonal.
+
+// Writes the mesh in the given format.
+std::string serialize(const trilib::generator::Mesh& mesh, trilib::service::Format format){
+	std::int32_t counts[2] = {mesh.num_vertices(), mesh.num_faces()};
+	std::string result;
+	if(format == trilib::service::Format::binary){
+		result.append("BTRI", 4);
+		result.append(reinterpret_cast<const char*>(counts), sizeof(counts));
+		result.append(reinterpret_cast<const char*>(mesh.coordinates.data()), mesh.coordinates.size()*sizeof(double));
+		result.append(reinterpret_cast<const char*>(mesh.faces.data()), mesh.faces.size()*sizeof(std::int32_t));
+	}
+	else{
+		std::ostringstream out;
+		out.precision(std::numeric_limits<double>::max_digits10);
+		out<<"OFF\n"<<counts[0]<<" "<<counts[1]<<" 0\n";
+		for(std::size_t v = 0; v < mesh.coordinates.size(); v += 2){
+			out<<mesh.coordinates[v]<<" "<<mesh.coordinates[v+1]<<" 0\n";
+		}
+		for(std::size_t f = 0; f < mesh.faces.size(); f += 3){
+			out<<"3 "<<mesh.faces[f]<<" "<<mesh.faces[f+1]<<" "<<mesh.faces[f+2]<<"\n";
+		}
+		result = out.str();
+	}
+	return result;
+}
+
+double percentile(std::vector<double> values, double p){
+	std::sort(values.begin(), values.end());
+	std::size_t i = std::min(values.size() - 1, std::size_t(p * values.size()));
+	return values[i];
+}
+
+void usage(){
+	std::cerr<<"usage: bench_service socket_path [--binary] [--requests n]\n";
+}
+
+int main(int argc, char** argv){
+	namespace svc = trilib::service;
+	if(argc < 2){ usage(); return 2; }
+	std::string path(argv[1]);
+	svc::Format format = svc::Format::off;
+	int num_requests = 200;
+	for(int i = 2; i < argc; ++i){
+		std::string arg(argv[i]);
+		if(arg == "--binary"){ format = svc::Format::binary; }
+		else if( (arg == "--requests") && (i+1 < argc) ){ num_requests = std::max(1, std::atoi(argv[++i])); }
+		else{ usage(); return 2; }
+	}
+	int fd = svc::connect_unix(path);
+	if(fd < 0){
+		std::cerr<<"cannot connect to "<<path<<"\n";
+		return 1;
+	}
+	const int warmup_count = 5;
+	std::cout<<"faces bytes p50_ms p99_ms server_p50_ms server_p99_ms\n";
+	for(int n : {8, 16, 32, 64, 128}){
+		std::string payload = serialize(trilib::generator::make_grid_mesh(n, 0.0, n), format);
+		std::vector<double> round_trip;
+		std::vector<double> server;
+		svc::Response_header header;
+		std::string result;
+		for(int r = 0; r < warmup_count + num_requests; ++r){
+			auto start = std::chrono::steady_clock::now();
+			if(!svc::call(fd, format, payload, header, result) || (header.status != svc::Status::ok)){
+				std::cerr<<"request failed\n";
+				return 1;
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if(r >= warmup_count){
+				round_trip.push_back(1e3 * seconds);
+				server.push_back(1e3 * header.seconds);
+			}
+		}
+		std::cout<<2*(n-1)*(n-1)<<" "<<payload.size()<<" "<<percentile(round_trip, 0.5)<<" "<<percentile(round_trip, 0.99)
+		  <<" "<<percentile(server, 0.5)<<" "<<percentile(server, 0.99)<<"\n";
+	}
+	::close(fd);
+	return 0;
+}
@@ -0,0 +1,585 @@
+#ifndef COMPRESSED_IO_HPP
+#define COMPRESSED_IO_HPP
+#include<condition_variable>
+#include<cstddef>
+#include<cstring>
+#include<deque>
+#include<istream>
+#include<limits>
+#include<mutex>
+#include<ostream>
+#include<streambuf>
+#include<string>
+#include<thread>
+#include<utility>
+
+// Streaming gzip and zstd compression of the meshes read and written by
+// Triangulation_2 (in OFF or binary format), with the (de)compression on a
+// separate thread. An input stream detects the compression of its source
+// from the magic bytes, and a background thread decompresses the source
+// in chunks, which the parser consumes as they become available. An output
+// stream hands the formatted output to a background thread in chunks, which
+// compresses and writes them while the next chunk is formatted.
+// The formats are available if the programs are configured with the
+// libraries (i.e., with TRILIB_WITH_ZLIB and TRILIB_WITH_ZSTD nonzero);
+// uncompressed data is always supported (and passed through).
+#ifndef TRILIB_WITH_ZLIB
+#define TRILIB_WITH_ZLIB 0
+#endif
+#ifndef TRILIB_WITH_ZSTD
+#define TRILIB_WITH_ZSTD 0
+#endif
+#if TRILIB_WITH_ZLIB
+#include<zlib.h>
+#endif
+#if TRILIB_WITH_ZSTD
+#include<zstd.h>
+#endif
+
+namespace trilib::io {
+
+	// The compression formats.
+	enum class Compression { none, gzip, zstd };
+
+	inline const char* compression_name(Compression compression){
+		switch(compression){
+			case Compression::gzip: return "gzip";
+			case Compression::zstd: return "zstd";
+			default: return "none";
+		}
+	}
+
+	// Parses the name of a compression format. Returns false if the name
+	// is not that of a format.
+	inline bool parse_compression(const std::string& name, Compression& compression){
+		for(Compression c : {Compression::none, Compression::gzip, Compression::zstd}){
+			if(name == compression_name(c)){
+				compression = c;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// The file name extension of a compression format (e.g., ".gz").
+	inline const char* compression_extension(Compression compression){
+		switch(compression){
+			case Compression::gzip: return ".gz";
+			case Compression::zstd: return ".zst";
+			default: return "";
+		}
+	}
+
+	// The highest compression level of a format (zero for none).
+	inline int max_compression_level(Compression compression){
+		switch(compression){
+			case Compression::gzip: return 9;
+			case Compression::zstd: return 19;
+			default: return 0;
+		}
+	}
+
+	// Parses a compression level of a format: from 1 to the highest level
+	// of the format, or 0 for the default level of the format. Returns
+	// false if text is not such a number.
+	inline bool parse_compression_level(const std::string& text, Compression compression, int& level){
+		if( text.empty() || (text.size() > 2) || (text.find_first_not_of("0123456789") != std::string::npos) ){ return false; }
+		int value = std::stoi(text);
+		if(value > max_compression_level(compression)){ return false; }
+		level = value;
+		return true;
+	}
+
+	// Tests if a compression format is compiled in.
+	inline bool is_available(Compression compression){
+		switch(compression){
+			case Compression::gzip: return TRILIB_WITH_ZLIB != 0;
+			case Compression::zstd: return TRILIB_WITH_ZSTD != 0;
+			default: return true;
+		}
+	}
+
+	// Detects the compression of data from its first size bytes (at most
+	// four are needed).
+	inline Compression detect_compression(const unsigned char* bytes, std::size_t size){
+		if( (size >= 2) && (bytes[0] == 0x1f) && (bytes[1] == 0x8b) ){ return Compression::gzip; }
+		if( (size >= 4) && (bytes[0] == 0x28) && (bytes[1] == 0xb5) && (bytes[2] == 0x2f) && (bytes[3] == 0xfd) ){ return Compression::zstd; }
+		return Compression::none;
+	}
+
+	// The default size of the chunks handed between the threads.
+	constexpr std::size_t default_chunk_size = std::size_t(1) << 20;
+
+	namespace detail {
+
+		// A bounded queue of chunks from a producer thread to a consumer
+		// thread. Either side may stop early: the producer by finishing
+		// (possibly with an error), the consumer by cancelling.
+		class Chunk_queue {
+			public:
+				explicit Chunk_queue(std::size_t capacity) : capacity_(capacity), finished_(false), cancelled_(false) {}
+
+				// Waits for room and appends a chunk. Returns false if the
+				// consumer has cancelled.
+				bool push(std::string&& chunk){
+					std::unique_lock<std::mutex> lock(mutex_);
+					not_full_.wait(lock, [this](){ return cancelled_ || (chunks_.size() < capacity_); });
+					if(cancelled_){ return false; }
+					chunks_.push_back(std::move(chunk));
+					not_empty_.notify_one();
+					return true;
+				}
+
+				// Waits for a chunk and removes it. Returns false if the
+				// producer has finished and every chunk has been removed.
+				bool pop(std::string& chunk){
+					std::unique_lock<std::mutex> lock(mutex_);
+					not_empty_.wait(lock, [this](){ return finished_ || !chunks_.empty(); });
+					if(chunks_.empty()){ return false; }
+					chunk = std::move(chunks_.front());
+					chunks_.pop_front();
+					not_full_.notify_one();
+					return true;
+				}
+
+				// Marks the end of the chunks, with an error message if the
+				// producer failed.
+				void finish(const std::string& error = std::string()){
+					std::lock_guard<std::mutex> lock(mutex_);
+					finished_ = true;
+					error_ = error;
+					not_empty_.notify_all();
+				}
+
+				// Stops the producer (discarding the chunks not yet removed).
+				void cancel(){
+					std::lock_guard<std::mutex> lock(mutex_);
+					cancelled_ = true;
+					chunks_.clear();
+					not_full_.notify_all();
+				}
+
+				// Gets the error message of the producer (empty if none).
+				std::string error() const {
+					std::lock_guard<std::mutex> lock(mutex_);
+					return error_;
+				}
+
+			private:
+				std::size_t capacity_;
+				mutable std::mutex mutex_;
+				std::condition_variable not_empty_;
+				std::condition_variable not_full_;
+				std::deque<std::string> chunks_;
+				bool finished_;
+				bool cancelled_;
+				std::string error_;
+		};
+
+	}
+
+	// A stream buffer reading the (possibly compressed) data of a source
+	// stream, decompressed on a separate thread.
+	class Decompressing_streambuf : public std::streambuf {
+		public:
+			explicit Decompressing_streambuf(std::istream& source, std::size_t chunk_size = default_chunk_size) :
+			  source_(source), chunk_size_(chunk_size), queue_(4) {
+				unsigned char magic[4];
+				source_.read(reinterpret_cast<char*>(magic), sizeof(magic));
+				std::string prefix(reinterpret_cast<const char*>(magic), std::size_t(source_.gcount()));
+				compression_ = detect_compression(magic, prefix.size());
+				worker_ = std::thread([this, prefix](){ run(prefix); });
+			}
+			~Decompressing_streambuf(){
+				queue_.cancel();
+				worker_.join();
+			}
+			Decompressing_streambuf(const Decompressing_streambuf&) = delete;
+			Decompressing_streambuf& operator=(const Decompressing_streambuf&) = delete;
+
+			// Gets the detected compression of the source.
+			Compression compression() const { return compression_; }
+
+			// Gets the error of the decompression (empty if none), which is
+			// known once the end of the data has been reached.
+			std::string error() const { return queue_.error(); }
+
+		protected:
+			int_type underflow() override {
+				if(gptr() < egptr()){ return traits_type::to_int_type(*gptr()); }
+				do{
+					if(!queue_.pop(current_)){ return traits_type::eof(); }
+				} while(current_.empty());
+				setg(&current_[0], &current_[0], &current_[0] + current_.size());
+				return traits_type::to_int_type(*gptr());
+			}
+
+		private:
+			// Reads the next chunk of the source (after the prefix) into
+			// chunk. Returns false at the end of the source.
+			bool read_source(std::string& chunk){
+				chunk.resize(chunk_size_);
+				source_.read(&chunk[0], chunk.size());
+				chunk.resize(std::size_t(source_.gcount()));
+				return !chunk.empty();
+			}
+
+			void run(std::string prefix){
+				switch(compression_){
+					case Compression::gzip: run_gzip(std::move(prefix)); break;
+					case Compression::zstd: run_zstd(std::move(prefix)); break;
+					default: run_none(std::move(prefix)); break;
+				}
+			}
+
+			void run_none(std::string chunk){
+				do{
+					if(!queue_.push(std::move(chunk))){ return; }
+					chunk = std::string();
+				} while(read_source(chunk));
+				queue_.finish();
+			}
+
+			void run_gzip(std::string input){
+#if TRILIB_WITH_ZLIB
+				z_stream stream;
+				std::memset(&stream, 0, sizeof(stream));
+				// Accept the gzip and zlib headers.
+				if(inflateInit2(&stream, 15 + 32) != Z_OK){
+					queue_.finish("cannot initialize gzip decompression");
+					return;
+				}
+				std::string error;
+				int status = Z_OK;
+				do{
+					stream.next_in = reinterpret_cast<Bytef*>(&input[0]);
+					stream.avail_in = uInt(input.size());
+					while(stream.avail_in > 0){
+						// A gzip file may consist of several members.
+						if(status == Z_STREAM_END){ inflateReset(&stream); }
+						std::string output(chunk_size_, '\0');
+						stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+						stream.avail_out = uInt(output.size());
+						status = inflate(&stream, Z_NO_FLUSH);
+						if( (status != Z_OK) && (status != Z_STREAM_END) && (status != Z_BUF_ERROR) ){
+							error = "invalid gzip data";
+							break;
+						}
+						output.resize(output.size() - stream.avail_out);
+						if(!output.empty() && !queue_.push(std::move(output))){
+							inflateEnd(&stream);
+							return;
+						}
+					}
+				} while(error.empty() && read_source(input));
+				// Flush the output still held by zlib.
+				while(error.empty() && (status == Z_OK)){
+					std::string output(chunk_size_, '\0');
+					stream.next_in = nullptr;
+					stream.avail_in = 0;
+					stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+					stream.avail_out = uInt(output.size());
+					status = inflate(&stream, Z_NO_FLUSH);
+					output.resize(output.size() - stream.avail_out);
+					if(output.empty()){ break; }
+					if(!queue_.push(std::move(output))){
+						inflateEnd(&stream);
+						return;
+					}
+				}
+				if(error.empty() && (status != Z_STREAM_END)){ error = "truncated gzip data"; }
+				inflateEnd(&stream);
+				queue_.finish(error);
+#else
+				static_cast<void>(input);
+				queue_.finish("gzip support is not compiled in");
+#endif
+			}
+
+			void run_zstd(std::string input){
+#if TRILIB_WITH_ZSTD
+				ZSTD_DStream* stream = ZSTD_createDStream();
+				if(!stream || ZSTD_isError(ZSTD_initDStream(stream))){
+					if(stream){ ZSTD_freeDStream(stream); }
+					queue_.finish("cannot initialize zstd decompression");
+					return;
+				}
+				std::string error;
+				std::size_t status = 0;
+				do{
+					ZSTD_inBuffer in{input.data(), input.size(), 0};
+					while(in.pos < in.size){
+						std::string output(chunk_size_, '\0');
+						ZSTD_outBuffer out{&output[0], output.size(), 0};
+						status = ZSTD_decompressStream(stream, &out, &in);
+						if(ZSTD_isError(status)){
+							error = "invalid zstd data";
+							break;
+						}
+						output.resize(out.pos);
+						if(!output.empty() && !queue_.push(std::move(output))){
+							ZSTD_freeDStream(stream);
+							return;
+						}
+					}
+				} while(error.empty() && read_source(input));
+				// Flush the output still held by zstd.
+				while(error.empty() && (status != 0)){
+					std::string output(chunk_size_, '\0');
+					ZSTD_inBuffer in{nullptr, 0, 0};
+					ZSTD_outBuffer out{&output[0], output.size(), 0};
+					status = ZSTD_decompressStream(stream, &out, &in);
+					if(ZSTD_isError(status) || (out.pos == 0)){ break; }
+					output.resize(out.pos);
+					if(!queue_.push(std::move(output))){
+						ZSTD_freeDStream(stream);
+						return;
+					}
+				}
+				if(error.empty() && (status != 0)){ error = "truncated zstd data"; }
+				ZSTD_freeDStream(stream);
+				queue_.finish(error);
+#else
+				static_cast<void>(input);
+				queue_.finish("zstd support is not compiled in");
+#endif
+			}
+
+			std::istream& source_;
+			std::size_t chunk_size_;
+			Compression compression_;
+			detail::Chunk_queue queue_;
+			std::string current_;
+			std::thread worker_;
+	};
+
+	// A stream buffer writing (possibly compressed) data to a sink stream,
+	// compressed on a separate thread.
+	class Compressing_streambuf : public std::streambuf {
+		public:
+			// The level is that of the format (i.e., 1 to 9 for gzip and 1 to
+			// 19 for zstd), or 0 for the default level of the format.
+			Compressing_streambuf(std::ostream& sink, Compression compression, int level = 0,
+			  std::size_t chunk_size = default_chunk_size) :
+			  sink_(sink), compression_(compression), level_(level), chunk_size_(chunk_size), queue_(4), closed_(false) {
+				buffer_.resize(chunk_size_);
+				setp(&buffer_[0], &buffer_[0] + buffer_.size());
+				worker_ = std::thread([this](){ run(); });
+			}
+			~Compressing_streambuf(){
+				close();
+			}
+			Compressing_streambuf(const Compressing_streambuf&) = delete;
+			Compressing_streambuf& operator=(const Compressing_streambuf&) = delete;
+
+			// Writes the remaining data and the end of the compressed
+			// stream, and waits for the sink to be written. Returns true
+			// upon success. Nothing can be written afterwards.
+			bool close(){
+				if(!closed_){
+					closed_ = true;
+					hand_off();
+					queue_.finish();
+					worker_.join();
+					setp(nullptr, nullptr);
+				}
+				return error_.empty() && bool(sink_);
+			}
+
+			// Gets the error of the compression (empty if none), which is
+			// known once the stream buffer is closed.
+			const std::string& error() const { return error_; }
+
+		protected:
+			int_type overflow(int_type ch) override {
+				if(closed_){ return traits_type::eof(); }
+				hand_off();
+				if(!traits_type::eq_int_type(ch, traits_type::eof())){
+					*pptr() = traits_type::to_char_type(ch);
+					pbump(1);
+				}
+				return traits_type::not_eof(ch);
+			}
+
+			// The data is written as the chunks are compressed, so a sync
+			// only hands off the partial chunk.
+			int sync() override {
+				if(closed_){ return -1; }
+				hand_off();
+				return 0;
+			}
+
+		private:
+			// Hands the buffered data to the worker, and starts a new chunk.
+			void hand_off(){
+				std::size_t size = std::size_t(pptr() - pbase());
+				if(size == 0){ return; }
+				buffer_.resize(size);
+				queue_.push(std::move(buffer_));
+				buffer_ = std::string(chunk_size_, '\0');
+				setp(&buffer_[0], &buffer_[0] + buffer_.size());
+			}
+
+			void run(){
+				switch(compression_){
+					case Compression::gzip: run_gzip(); break;
+					case Compression::zstd: run_zstd(); break;
+					default: run_none(); break;
+				}
+				// Drain the queue after an error, so that the writer is not
+				// blocked.
+				std::string chunk;
+				while(queue_.pop(chunk)){}
+				sink_.flush();
+			}
+
+			void run_none(){
+				std::string chunk;
+				while(queue_.pop(chunk)){
+					if(!sink_.write(chunk.data(), chunk.size())){
+						error_ = "cannot write the output";
+						return;
+					}
+				}
+			}
+
+			void run_gzip(){
+#if TRILIB_WITH_ZLIB
+				z_stream stream;
+				std::memset(&stream, 0, sizeof(stream));
+				// Write the gzip header.
+				if(deflateInit2(&stream, (level_ > 0) ? level_ : Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK){
+					error_ = "cannot initialize gzip compression";
+					return;
+				}
+				std::string chunk;
+				std::string output(chunk_size_, '\0');
+				bool more = true;
+				while(more){
+					more = queue_.pop(chunk);
+					int flush = more ? Z_NO_FLUSH : Z_FINISH;
+					stream.next_in = reinterpret_cast<Bytef*>(more ? &chunk[0] : nullptr);
+					stream.avail_in = more ? uInt(chunk.size()) : 0;
+					int status;
+					do{
+						stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+						stream.avail_out = uInt(output.size());
+						status = deflate(&stream, flush);
+						std::size_t size = output.size() - stream.avail_out;
+						if( (status == Z_STREAM_ERROR) || !sink_.write(output.data(), size) ){
+							error_ = "cannot write the gzip output";
+							deflateEnd(&stream);
+							return;
+						}
+					} while( (stream.avail_out == 0) || ( (flush == Z_FINISH) && (status != Z_STREAM_END) ) );
+				}
+				deflateEnd(&stream);
+#else
+				error_ = "gzip support is not compiled in";
+#endif
+			}
+
+			void run_zstd(){
+#if TRILIB_WITH_ZSTD
+				ZSTD_CStream* stream = ZSTD_createCStream();
+				if(!stream || ZSTD_isError(ZSTD_initCStream(stream, (level_ > 0) ? level_ : 3))){
+					if(stream){ ZSTD_freeCStream(stream); }
+					error_ = "cannot initialize zstd compression";
+					return;
+				}
+				std::string chunk;
+				std::string output(ZSTD_CStreamOutSize(), '\0');
+				while(queue_.pop(chunk)){
+					ZSTD_inBuffer in{chunk.data(), chunk.size(), 0};
+					while(in.pos < in.size){
+						ZSTD_outBuffer out{&output[0], output.size(), 0};
+						std::size_t status = ZSTD_compressStream(stream, &out, &in);
+						if(ZSTD_isError(status) || !sink_.write(output.data(), out.pos)){
+							error_ = "cannot write the zstd output";
+							ZSTD_freeCStream(stream);
+							return;
+						}
+					}
+				}
+				std::size_t remaining;
+				do{
+					ZSTD_outBuffer out{&output[0], output.size(), 0};
+					remaining = ZSTD_endStream(stream, &out);
+					if(ZSTD_isError(remaining) || !sink_.write(output.data(), out.pos)){
+						error_ = "cannot write the zstd output";
+						break;
+					}
+				} while(remaining > 0);
+				ZSTD_freeCStream(stream);
+#else
+				error_ = "zstd support is not compiled in";
+#endif
+			}
+
+			std::ostream& sink_;
+			Compression compression_;
+			int level_;
+			std::size_t chunk_size_;
+			detail::Chunk_queue queue_;
+			std::string buffer_;
+			// Written by the worker, and read after it is joined.
+			std::string error_;
+			bool closed_;
+			std::thread worker_;
+	};
+
+	// An input stream reading the (possibly compressed) data of a source
+	// stream (e.g., for Triangulation_2::input_off). The compression is
+	// detected from the first bytes of the source.
+	class Input_stream : public std::istream {
+		public:
+			explicit Input_stream(std::istream& source, std::size_t chunk_size = default_chunk_size) :
+			  std::istream(nullptr), buffer_(source, chunk_size) {
+				rdbuf(&buffer_);
+			}
+
+			// Gets the detected compression of the source.
+			Compression compression() const { return buffer_.compression(); }
+
+			// Gets the error of the decompression (empty if none).
+			std::string error() const { return buffer_.error(); }
+
+			// Reads and discards the rest of the data (e.g., after a mesh
+			// has been read), so that the end of the compressed data (e.g.,
+			// a truncated gzip trailer) is checked. Returns true if the data
+			// ends without an error.
+			bool read_to_end(){
+				clear();
+				ignore(std::numeric_limits<std::streamsize>::max());
+				return error().empty();
+			}
+
+		private:
+			Decompressing_streambuf buffer_;
+	};
+
+	// An output stream writing (possibly compressed) data to a sink stream
+	// (e.g., for Triangulation_2::output_off). The output is only complete
+	// once the stream is closed (which the destructor does, if needed).
+	class Output_stream : public std::ostream {
+		public:
+			Output_stream(std::ostream& sink, Compression compression, int level = 0, std::size_t chunk_size = default_chunk_size) :
+			  std::ostream(nullptr), buffer_(sink, compression, level, chunk_size) {
+				rdbuf(&buffer_);
+			}
+
+			// Closes the stream (see Compressing_streambuf::close). Returns
+			// true upon success.
+			bool close(){
+				return buffer_.close() && !fail();
+			}
+
+			// Gets the error of the compression (empty if none).
+			const std::string& error() const { return buffer_.error(); }
+
+		private:
+			Compressing_streambuf buffer_;
+	};
+
+}
+#endif
@@ -0,0 +1,348 @@
+#ifndef DC_DELAUNAY_HPP
+#define DC_DELAUNAY_HPP
+#include<cstddef>
+#include<cstdint>
+#include<vector>
+#include<thread>
+#include<utility>
+#include<algorithm>
+#include"ra/kernel.hpp"
+#include"triangulation_2.hpp"
+#include"pd_delaunay.hpp"
+
+namespace trilib {
+
+	// Builds the Delaunay triangulation of a set of points by the
+	// divide-and-conquer algorithm of Guibas and Stolfi, on a quad-edge
+	// structure of its own. The points are sorted once, the two halves
+	// of each subproblem are triangulated (on separate threads near the
+	// top of the recursion) and then merged along the seam. Each
+	// subproblem of the sorted points in [lo, hi) only uses the edges in
+	// [3 lo, 3 hi) (which is enough, since a planar graph on m vertices
+	// has fewer than 3 m edges), so the threads never share an edge.
+	// The merge deletes an edge only if a point is strictly inside a
+	// circle, so where four or more points are cocircular, the result is
+	// one of the Delaunay triangulations; the preferred-directions
+	// tie-break is applied afterwards (see dc_pd_delaunay).
+	template<class K, class Point>
+	class Dc_builder {
+		public:
+			// The smallest number of points for which a subproblem is split
+			// across two threads.
+			static constexpr int min_points_per_thread = 1 << 14;
+
+			Dc_builder(const K& kernel, const std::vector<Point>& points) :
+			  kernel_(kernel), points_(points), next_(12 * points.size()), org_(12 * points.size(), -1) {}
+
+			// Triangulates the points with the given order (which must be
+			// sorted by x and then y, without duplicates) using up to
+			// num_threads threads.
+			void build(const std::vector<int>& order, int num_threads){
+				order_ = &order;
+				if(order.size() >= 2){
+					std::vector<int> pool;
+					solve(0, int(order.size()), std::max(1, num_threads), pool);
+				}
+			}
+
+			// Gets the faces of the triangulation as the (CCW) vertex
+			// indices of each face.
+			std::vector<std::int32_t> faces() const {
+				using Orientation = typename K::Orientation;
+				std::vector<std::int32_t> result;
+				std::vector<bool> visited(next_.size(), false);
+				for(std::size_t q = 0; 4 * q < next_.size(); ++q){
+					if(org_[4 * q] < 0){ continue; }
+					for(int e : {int(4 * q), int(4 * q + 2)}){
+						if(visited[e]){ continue; }
+						int a = e;
+						int b = lnext(a);
+						int c = lnext(b);
+						visited[a] = true;
+						if( (lnext(c) == a) && (kernel_.orientation(points_[org(a)], points_[org(b)], points_[org(c)]) == Orientation::left_turn) ){
+							visited[b] = true;
+							visited[c] = true;
+							result.insert(result.end(), {org(a), org(b), org(c)});
+						}
+					}
+				}
+				return result;
+			}
+
+			// Gets the endpoints of the edges that need a flip to be
+			// preferred-directions Delaunay with respect to u and v (i.e.,
+			// those with four cocircular points), testing the edges on up to
+			// num_threads threads.
+			template<class U, class V>
+			std::vector<std::pair<int,int>> pd_violations(const U& u, const V& v, int num_threads) const {
+				int num_quads = int(next_.size() / 4);
+				num_threads = std::max(1, std::min(num_threads, num_quads / min_points_per_thread));
+				int quads_per_range = (num_quads + num_threads - 1) / num_threads;
+				std::vector<std::vector<std::pair<int,int>>> results(num_threads);
+				auto process = [&](int r){
+					int end = std::min(num_quads, (r + 1) * quads_per_range);
+					for(int q = r * quads_per_range; q < end; ++q){
+						int e = 4 * q;
+						if(org_[e] < 0){ continue; }
+						// The faces to the left of e and of its reverse.
+						int f = lnext(e);
+						int g = lnext(sym(e));
+						if( (lnext(lnext(f)) != e) || (lnext(lnext(g)) != sym(e)) ){ continue; }
+						const Point& a = points_[org(e)];
+						const Point& b = points_[org(lnext(g))];
+						const Point& c = points_[org(f)];
+						const Point& d = points_[org(lnext(f))];
+						if(is_face(e) && is_face(sym(e)) && kernel_.needs_pd_flip(a,b,c,d,u,v)){
+							results[r].push_back(std::make_pair(org(e), org(f)));
+						}
+					}
+				};
+				std::vector<std::thread> threads;
+				for(int r = 1; r < num_threads; ++r){ threads.emplace_back(process, r); }
+				process(0);
+				for(auto& t : threads){ t.join(); }
+				std::vector<std::pair<int,int>> result;
+				for(auto& range : results){ result.insert(result.end(), range.begin(), range.end()); }
+				return result;
+			}
+
+		private:
+			using Orientation = typename K::Orientation;
+			using Oriented_side = typename K::Oriented_side;
+
+			// The directed edges of quad-edge q are 4 q (from org to dest),
+			// 4 q + 2 (its reverse), and 4 q + 1 and 4 q + 3 (the dual edges).
+			static int rot(int e){ return (e & ~3) | ((e + 1) & 3); }
+			static int sym(int e){ return e ^ 2; }
+			static int rotinv(int e){ return (e & ~3) | ((e + 3) & 3); }
+			int onext(int e) const { return next_[e]; }
+			int oprev(int e) const { return rot(onext(rot(e))); }
+			int lnext(int e) const { return rot(onext(rotinv(e))); }
+			int rprev(int e) const { return onext(sym(e)); }
+			int org(int e) const { return org_[e]; }
+			int dest(int e) const { return org_[sym(e)]; }
+
+			// Tests if the face to the left of e is a CCW triangle.
+			bool is_face(int e) const {
+				return kernel_.orientation(points_[org(e)], points_[dest(e)], points_[dest(lnext(e))]) == Orientation::left_turn;
+			}
+
+			bool ccw(int a, int b, int c) const {
+				return kernel_.orientation(points_[a], points_[b], points_[c]) == Orientation::left_turn;
+			}
+			bool right_of(int x, int e) const { return ccw(x, dest(e), org(e)); }
+			bool left_of(int x, int e) const { return ccw(x, org(e), dest(e)); }
+			// Tests if d is strictly inside the circle through a, b, and c.
+			bool in_circle(int a, int b, int c, int d) const {
+				return kernel_.side_of_oriented_circle(points_[a], points_[b], points_[c], points_[d]) == Oriented_side::on_positive_side;
+			}
+
+			int make_edge(int a, int b, std::vector<int>& pool){
+				int e = 4 * pool.back();
+				pool.pop_back();
+				next_[e] = e;
+				next_[e + 1] = e + 3;
+				next_[e + 2] = e + 2;
+				next_[e + 3] = e + 1;
+				org_[e] = a;
+				org_[e + 2] = b;
+				return e;
+			}
+
+			void splice(int a, int b){
+				int alpha = rot(onext(a));
+				int beta = rot(onext(b));
+				std::swap(next_[a], next_[b]);
+				std::swap(next_[alpha], next_[beta]);
+			}
+
+			int connect(int a, int b, std::vector<int>& pool){
+				int e = make_edge(dest(a), org(b), pool);
+				splice(e, lnext(a));
+				splice(sym(e), b);
+				return e;
+			}
+
+			void delete_edge(int e, std::vector<int>& pool){
+				splice(e, oprev(e));
+				splice(sym(e), oprev(sym(e)));
+				org_[e & ~3] = -1;
+				pool.push_back(e >> 2);
+			}
+
+			// Triangulates the sorted points in [lo, hi), returning the CCW
+			// convex hull edge out of the leftmost point and the CW convex
+			// hull edge out of the rightmost point. The unused quad-edges of
+			// [3 lo, 3 hi) are left in pool.
+			std::pair<int,int> solve(int lo, int hi, int num_threads, std::vector<int>& pool){
+				const std::vector<int>& s = *order_;
+				int n = hi - lo;
+				if(n <= 3){
+					for(int q = 3 * hi - 1; q >= 3 * lo; --q){ pool.push_back(q); }
+					if(n == 2){
+						int a = make_edge(s[lo], s[lo + 1], pool);
+						return std::make_pair(a, sym(a));
+					}
+					int a = make_edge(s[lo], s[lo + 1], pool);
+					int b = make_edge(s[lo + 1], s[lo + 2], pool);
+					splice(sym(a), b);
+					if(ccw(s[lo], s[lo + 1], s[lo + 2])){
+						connect(b, a, pool);
+						return std::make_pair(a, sym(b));
+					}
+					else if(ccw(s[lo], s[lo + 2], s[lo + 1])){
+						int c = connect(b, a, pool);
+						return std::make_pair(sym(c), c);
+					}
+					return std::make_pair(a, sym(b));
+				}
+				int mid = lo + n / 2;
+				std::vector<int> left_pool;
+				std::vector<int> right_pool;
+				std::pair<int,int> left;
+				std::pair<int,int> right;
+				if( (num_threads > 1) && (n >= 2 * min_points_per_thread) ){
+					std::thread worker([&](){ left = solve(lo, mid, num_threads / 2, left_pool); });
+					right = solve(mid, hi, num_threads - num_threads / 2, right_pool);
+					worker.join();
+				}
+				else{
+					left = solve(lo, mid, 1, left_pool);
+					right = solve(mid, hi, 1, right_pool);
+				}
+				if(left_pool.size() < right_pool.size()){ left_pool.swap(right_pool); }
+				pool.swap(left_pool);
+				pool.insert(pool.end(), right_pool.begin(), right_pool.end());
+				return merge(left.first, left.second, right.first, right.second, pool);
+			}
+
+			// Merges the triangulations with the hull edges (ldo, ldi) and
+			// (rdi, rdo) returned by solve.
+			std::pair<int,int> merge(int ldo, int ldi, int rdi, int rdo, std::vector<int>& pool){
+				// Find the lower common tangent of the two hulls.
+				while(true){
+					if(left_of(org(rdi), ldi)){ ldi = lnext(ldi); }
+					else if(right_of(org(ldi), rdi)){ rdi = rprev(rdi); }
+					else{ break; }
+				}
+				int basel = connect(sym(rdi), ldi, pool);
+				if(org(ldi) == org(ldo)){ ldo = sym(basel); }
+				if(org(rdi) == org(rdo)){ rdo = basel; }
+				// Add the cross edges from the bottom of the seam to the top.
+				while(true){
+					int lcand = onext(sym(basel));
+					bool lvalid = right_of(dest(lcand), basel);
+					if(lvalid){
+						while(in_circle(dest(basel), org(basel), dest(lcand), dest(onext(lcand)))){
+							int t = onext(lcand);
+							delete_edge(lcand, pool);
+							lcand = t;
+						}
+					}
+					int rcand = oprev(basel);
+					bool rvalid = right_of(dest(rcand), basel);
+					if(rvalid){
+						while(in_circle(dest(basel), org(basel), dest(rcand), dest(oprev(rcand)))){
+							int t = oprev(rcand);
+							delete_edge(rcand, pool);
+							rcand = t;
+						}
+					}
+					// The deletions may have made a candidate invalid.
+					lvalid = right_of(dest(lcand), basel);
+					rvalid = right_of(dest(rcand), basel);
+					if(!lvalid && !rvalid){ break; }
+					if(!lvalid || (rvalid && in_circle(dest(lcand), org(lcand), org(rcand), dest(rcand)))){
+						basel = connect(rcand, sym(basel), pool);
+					}
+					else{
+						basel = connect(sym(basel), sym(lcand), pool);
+					}
+				}
+				return std::make_pair(ldo, rdo);
+			}
+
+			const K& kernel_;
+			const std::vector<Point>& points_;
+			const std::vector<int>* order_;
+			std::vector<int> next_;
+			std::vector<int> org_;
+	};
+
+	// Sorts the indices in [first, last) with the comparison less, with the
+	// two halves sorted on separate threads (recursively, up to
+	// num_threads threads).
+	template<class Iterator, class Compare>
+	void parallel_sort(Iterator first, Iterator last, Compare less, int num_threads){
+		constexpr std::ptrdiff_t min_size = 1 << 16;
+		if( (num_threads < 2) || (last - first < 2 * min_size) ){
+			std::sort(first, last, less);
+			return;
+		}
+		Iterator middle = first + (last - first) / 2;
+		std::thread worker([&](){ parallel_sort(first, middle, less, num_threads / 2); });
+		parallel_sort(middle, last, less, num_threads - num_threads / 2);
+		worker.join();
+		std::inplace_merge(first, middle, last, less);
+	}
+
+	// Builds the preferred-directions Delaunay triangulation (with respect
+	// to the first and second directions u and v) of the points with the
+	// given coordinates (two per point) into tri, by divide and conquer on
+	// up to num_threads threads. The vertices of tri have the indices of
+	// the points as ids. The result is the same as that of applying the
+	// LOP to any triangulation of the points: the Delaunay triangulation
+	// built by divide and conquer differs from it only by the edges whose
+	// four points are cocircular, which are flipped by a LOP started from
+	// these edges alone. As for pd_delaunay_lop, the directions may be
+	// vectors or ra::geometry::Fixed_direction. The input is checked at the
+	// level of validation of tri (the trusted level skips the checks, which
+	// are redundant for this triangulation). The statistics of the LOP are
+	// added to stat (if not null).
+	// Returns false if the points have duplicates or are all collinear (in
+	// which case there is no triangulation).
+	template<class Tri, class K, class U, class V>
+	bool dc_pd_delaunay(Tri& tri, const K& kernel, const U& u, const V& v,
+	  const double* coordinates, int num_vertices, int num_threads, Lop_statistics* stat = nullptr){
+		using Point = typename Tri::Point;
+		using Halfedge_handle = typename Tri::Halfedge_handle;
+		if(num_vertices < 3){ return false; }
+		std::vector<Point> points;
+		points.reserve(num_vertices);
+		for(int i = 0; i < num_vertices; ++i){
+			points.push_back(Point(coordinates[2 * std::size_t(i)], coordinates[2 * std::size_t(i) + 1]));
+		}
+		std::vector<int> order(num_vertices);
+		for(int i = 0; i < num_vertices; ++i){ order[i] = i; }
+		auto less = [&points](int i, int j){
+			return (points[i].x() < points[j].x()) || ( (points[i].x() == points[j].x()) && (points[i].y() < points[j].y()) );
+		};
+		parallel_sort(order.begin(), order.end(), less, num_threads);
+		for(int i = 1; i < num_vertices; ++i){
+			if(points[order[i - 1]] == points[order[i]]){ return false; }
+		}
+
+		Dc_builder<K,Point> builder(kernel, points);
+		builder.build(order, num_threads);
+		std::vector<std::int32_t> faces = builder.faces();
+		if(faces.empty()){ return false; }
+		std::vector<std::pair<int,int>> violations = builder.pd_violations(u, v, num_threads);
+		if(!tri.input_arrays(coordinates, num_vertices, faces.data(), int(faces.size() / 3))){ return false; }
+
+		// Apply the tie-break by a LOP from the violating edges.
+		Lop_statistics local{0,0,0};
+		if(!violations.empty()){
+			std::vector<Halfedge_handle> suspect_list = find_edges(tri, violations);
+			local.suspect_push_count += suspect_list.size();
+			restore_pd_delaunay(tri, kernel, u, v, suspect_list, local);
+		}
+		if(stat){
+			stat->flip_count += local.flip_count;
+			stat->suspect_push_count += local.suspect_push_count;
+			stat->test_count += local.test_count;
+		}
+		return true;
+	}
+
+}
+#endif
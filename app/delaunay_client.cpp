@@ -0,0 +1,50 @@
+#include<iostream>
+#include<iterator>
+#include<string>
+#include<chrono>
+#include<cstdlib>
+#include"service.hpp"
+
+// A client of the service mode of delaunay_triangulation.
+// Sends the mesh read from the standard input to the server and writes the
+// resulting mesh to the standard output.
+
+void usage(){
+	std::cerr<<"usage: delaunay_client socket_path [--binary] < input > output\n";
+}
+
+int main(int argc, char** argv){
+	namespace svc = trilib::service;
+	if(argc < 2){ usage(); return 2; }
+	std::string path(argv[1]);
+	svc::Format format = svc::Format::off;
+	for(int i = 2; i < argc; ++i){
+		std::string arg(argv[i]);
+		if(arg == "--binary"){ format = svc::Format::binary; }
+		else{ usage(); return 2; }
+	}
+	std::string payload((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+
+	int fd = svc::connect_unix(path);
+	if(fd < 0){
+		std::cerr<<"cannot connect to "<<path<<"\n";
+		return 1;
+	}
+	auto start = std::chrono::steady_clock::now();
+	svc::Response_header header;
+	std::string result;
+	bool ok = svc::call(fd, format, payload, header, result);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	::close(fd);
+	if(!ok){
+		std::cerr<<"connection failed\n";
+		return 1;
+	}
+	if(header.status != svc::Status::ok){
+		std::cerr<<"request failed (status "<<static_cast<unsigned>(header.status)<<")\n";
+		return 1;
+	}
+	std::cout.write(result.data(), result.size());
+	std::cerr<<"flips="<<header.flip_count<<" server_time="<<header.seconds<<" round_trip_time="<<seconds<<"\n";
+	return 0;
+}
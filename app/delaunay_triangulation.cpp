@@ -1,70 +1,681 @@
 #include<iostream>
+#include<fstream>
+#include<string>
+#include<vector>
+#include<thread>
+#include<atomic>
+#include<chrono>
+#include<cfenv>
+#include<cstdlib>
+#include<algorithm>
+#include<filesystem>
+#include<csignal>
 #include"ra/kernel.hpp"
-#include <CGAL/Cartesian.h>
+#include"ra/alloc_profile.hpp"
+#include <CGAL/Simple_cartesian.h>
 #include "triangulation_2.hpp"
-#include<vector>
+#include "pd_delaunay.hpp"
+#include "dc_delaunay.hpp"
+#include "service.hpp"
+#include "perf_counters.hpp"
+#include "run_report.hpp"
+#include "compressed_io.hpp"
 
-using Kernel = CGAL::Cartesian<double>;
+using Kernel = CGAL::Simple_cartesian<double>;
 using kernel = ra::geometry::Kernel<double>;
 using Triangulation = trilib::Triangulation_2<Kernel>;
 using hEit = Triangulation::Halfedge_iterator;
 using hE_hand = Triangulation::Halfedge_handle;
-using point = CGAL::Cartesian<double>::Point_2;
-using vector = CGAL::Cartesian<double>::Vector_2;
+using point = CGAL::Simple_cartesian<double>::Point_2;
+using vector = CGAL::Simple_cartesian<double>::Vector_2;
+// The preferred directions, as compile-time constants (so that the
+// tie-break of the kernel reduces to sums of coordinates).
+using Directions = ra::geometry::Pd_directions<1,0,1,1>;
+// A triangulation storing its coordinates as float (see --float).
+using Float_triangulation = trilib::Triangulation_2<CGAL::Simple_cartesian<float>>;
+// The triangulations whose vertices cache their kernel values (see --vertex-cache).
+using Cached_triangulation = trilib::Triangulation_2<Kernel, true>;
+using Cached_float_triangulation = trilib::Triangulation_2<CGAL::Simple_cartesian<float>, true>;
+
+// The options controlling the order in which meshes are stored and written.
+struct Order_options {
+	// Store the vertices and faces along a Hilbert curve.
+	bool spatial_sort;
+	// Write the vertices in the order in which they are stored instead of
+	// the input order.
+	bool storage_order;
+	// The order in which the LOP processes the suspect edges.
+	trilib::Schedule schedule;
+	// The level of validation of the input meshes.
+	trilib::Validation validation;
+	// Cache the lifted coordinates and filter bounds of the vertices (by
+	// running on Cached_triangulation).
+	bool vertex_cache;
+	// The compression of the output meshes (the compression of the input
+	// meshes is detected).
+	trilib::io::Compression compression;
+	// The compression level (0 for the default level of the format).
+	int compression_level;
+};
+
+template<class Tri>
+void configure(Tri& tri, const Order_options& options){
+	tri.set_spatial_sort(options.spatial_sort);
+	tri.set_output_in_input_order(!options.storage_order);
+	tri.set_validation(options.validation);
+}
+
+// The options of the report of a run (in the default mode).
+struct Report_options {
+	// Write the report in JSON format.
+	bool json;
+	// The file to which the report is written (if empty, the standard error).
+	std::string path;
+};
+
+// The options of an anytime run of the LOP (in the default mode).
+struct Anytime_options {
+	// The budget of the LOP.
+	trilib::Lop_budget budget;
+	// Report the progress of the LOP to the standard error.
+	bool report_progress;
+	// The file to which the work-list is written (if not empty).
+	std::string worklist_path;
+	// The file of a work-list to resume from (if not empty).
+	std::string resume_path;
+
+	bool active() const {
+		return (budget.max_flips > 0) || (budget.max_seconds > 0.0) || report_progress || !worklist_path.empty() || !resume_path.empty();
+	}
+};
+
+// A job of the batch mode: one input mesh and its result.
+struct Batch_job {
+	std::filesystem::path input;
+	std::filesystem::path output;
+	std::uintmax_t size;
+	bool ok;
+	double seconds;
+	trilib::Lop_statistics lop;
+	kernel::Statistics kernel_stat;
+	ra::profile::Allocation_statistics alloc_stat;
+};
+
+// Computes the preferred-directions Delaunay triangulation of one mesh
+// of the batch. Since the kernel and allocation statistics are per
+// thread, clearing and reading them here gives the statistics of this job
+// alone.
+template<class Tri>
+void run_batch_job(Batch_job& job, const Order_options& options){
+	auto start = std::chrono::steady_clock::now();
+	kernel obj;
+	kernel::clear_statistics();
+	ra::profile::clear_statistics();
+	job.ok = false;
+	// Only the I/O streams and allocations throw; invalid input is reported
+	// by input_off and read_to_end.
+	try{
+		std::ifstream file_in(job.input, std::ios::binary);
+		trilib::io::Input_stream in(file_in);
+		Tri tri;
+		configure(tri, options);
+		if(tri.input_off(in) && in.read_to_end()){
+			job.lop = trilib::pd_delaunay_lop(tri,obj,Directions::u,Directions::v,options.schedule);
+			std::ofstream file_out(job.output, std::ios::binary);
+			trilib::io::Output_stream out(file_out, options.compression, options.compression_level);
+			job.ok = tri.output_off(out) && out.close();
+		}
+	}
+	catch(const std::exception& e){
+		job.ok = false;
+	}
+	if(!job.ok){
+		std::cerr<<"cannot triangulate "<<job.input<<"\n";
+	}
+	kernel::get_statistics(job.kernel_stat);
+	ra::profile::get_statistics(job.alloc_stat);
+	job.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Processes a list of meshes on a pool of threads, writing each result to
+// the output directory under the name of its input file. Jobs are handed
+// out largest file first, so that a large mesh does not start last and
+// stall the batch.
+template<class Tri>
+int run_batch(const std::vector<std::string>& inputs, const std::filesystem::path& output_dir, unsigned num_threads, const Order_options& options){
+	std::vector<Batch_job> jobs;
+	for(const std::string& name : inputs){
+		Batch_job job{};
+		job.input = name;
+		// The output is named after the input, with the extension of the
+		// compression of the output (instead of that of the input).
+		std::filesystem::path file_name = job.input.filename();
+		if( (file_name.extension() == ".gz") || (file_name.extension() == ".zst") ){ file_name.replace_extension(); }
+		job.output = output_dir / file_name;
+		job.output += trilib::io::compression_extension(options.compression);
+		std::error_code ec;
+		job.size = std::filesystem::file_size(job.input, ec);
+		if(ec){ job.size = 0; }
+		jobs.push_back(job);
+	}
+	std::vector<std::size_t> order(jobs.size());
+	for(std::size_t i = 0; i < order.size(); ++i){ order[i] = i; }
+	std::stable_sort(order.begin(), order.end(), [&jobs](std::size_t i, std::size_t j){ return jobs[i].size > jobs[j].size; });
+
+	std::atomic<std::size_t> next(0);
+	auto worker = [&](){
+		ra::math::rounding_mode_saver rms;
+		std::fesetround(FE_TONEAREST);
+		std::size_t i;
+		while( (i = next++) < order.size() ){
+			run_batch_job<Tri>(jobs[order[i]], options);
+		}
+	};
+	num_threads = std::max(1u, std::min<unsigned>(num_threads, jobs.size()));
+	std::vector<std::thread> pool;
+	for(unsigned t = 0; t < num_threads; ++t){ pool.emplace_back(worker); }
+	for(std::thread& t : pool){ t.join(); }
+
+	int status = 0;
+	for(const Batch_job& job : jobs){
+		std::cout<<job.input.string()<<" "<<(job.ok ? "ok" : "failed")<<" time="<<job.seconds<<" flips="<<job.lop.flip_count
+		  <<" suspects="<<job.lop.suspect_push_count<<" exact="<<job.kernel_stat.locally_pd_delaunay_edge_exact_count<<"\n";
+		if(ra::profile::enabled){ ra::profile::print_statistics(std::cout, job.alloc_stat); }
+		if(!job.ok){ status = 1; }
+	}
+	return status;
+}
+
+// Serves the requests read from in_fd, writing the responses to out_fd,
+// until the end of the input. The request and response buffers are kept
+// from one request to the next, as is the state of the thread (e.g., the
+// expansion arena of the kernel), so that a warm server does not pay for
+// process startup or for growing them again. The triangulation object is
+// reused, and the vertices, halfedges and faces freed by one request are
+// handed out again to the next (see Node_allocator), so that a request no
+// larger than an earlier one allocates no nodes. Since any client can
+// connect, each mesh is checked as untrusted input; an invalid mesh gets
+// an invalid_mesh response.
+// Returns false if the connection must be dropped.
+template<class Tri>
+bool serve_connection(int in_fd, int out_fd, Tri& tri, const Order_options& options, std::string& request, std::string& response){
+	namespace svc = trilib::service;
+	kernel obj;
+	svc::Request_header header;
+	while(svc::read_all(in_fd, &header, sizeof(header))){
+		auto start = std::chrono::steady_clock::now();
+		svc::Response_header reply{{'P','D','T','R'}, svc::Status::ok, 0, 0.0, 0};
+		response.clear();
+		if( (std::memcmp(header.magic, "PDTQ", 4) != 0) || (header.size > svc::max_payload_size) ||
+		  ((header.format != svc::Format::off) && (header.format != svc::Format::binary)) ){
+			// The stream cannot be resynchronized after a bad header.
+			reply.status = svc::Status::invalid_request;
+			svc::write_all(out_fd, &reply, sizeof(reply));
+			return false;
+		}
+		request.resize(header.size);
+		if(!svc::read_all(in_fd, &request[0], request.size())){ return false; }
+
+		svc::memory_buffer in_buffer(request.data(), request.size());
+		std::istream in(&in_buffer);
+		bool binary = (header.format == svc::Format::binary);
+		bool ok = binary ? tri.input_binary(in) : tri.input_off(in);
+		if(ok){
+			trilib::Lop_statistics lop = trilib::pd_delaunay_lop(tri,obj,Directions::u,Directions::v,options.schedule);
+			reply.flip_count = lop.flip_count;
+			svc::string_buffer out_buffer(response);
+			std::ostream out(&out_buffer);
+			ok = binary ? tri.output_binary(out) : tri.output_off(out);
+		}
+		if(!ok){
+			reply.status = svc::Status::invalid_mesh;
+			response.clear();
+		}
+		reply.size = response.size();
+		reply.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if( !svc::write_all(out_fd, &reply, sizeof(reply)) || !svc::write_all(out_fd, response.data(), response.size()) ){ return false; }
+	}
+	return true;
+}
+
+// Runs the service mode, listening on the Unix domain socket at path, or
+// reading requests from the standard input if path is "-". Connections
+// are served one at a time.
+template<class Tri>
+int run_service(const std::string& path, const Order_options& options){
+	std::signal(SIGPIPE, SIG_IGN);
+	ra::math::rounding_mode_saver rms;
+	std::fesetround(FE_TONEAREST);
+	Tri tri;
+	configure(tri, options);
+	std::string request;
+	std::string response;
+	if(path == "-"){
+		return serve_connection(0, 1, tri, options, request, response) ? 0 : 1;
+	}
+	int listen_fd = trilib::service::listen_unix(path);
+	if(listen_fd < 0){
+		std::cerr<<"cannot listen on "<<path<<"\n";
+		return 1;
+	}
+	std::cerr<<"listening on "<<path<<"\n";
+	while(true){
+		int fd = ::accept(listen_fd, nullptr, nullptr);
+		if(fd < 0){
+			if(errno == EINTR){ continue; }
+			break;
+		}
+		serve_connection(fd, fd, tri, options, request, response);
+		::close(fd);
+	}
+	::close(listen_fd);
+	return 1;
+}
 
+// Certifies that the mesh read from in is preferred-directions Delaunay,
+// printing the violating edges (if any). Returns true if it is.
+template<class Tri>
+bool verify(std::istream& source, const std::string& name, unsigned num_threads, const Order_options& options){
+	auto start = std::chrono::steady_clock::now();
+	trilib::io::Input_stream in(source);
+	Tri tri;
+	configure(tri, options);
+	tri.set_num_threads(int(num_threads));
+	if(!tri.input_off(in) || !in.read_to_end()){
+		std::cout<<name<<" failed"<<(in.error().empty() ? "" : " ("+in.error()+")")<<"\n";
+		return false;
+	}
+	double load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	start = std::chrono::steady_clock::now();
+	kernel obj;
+	auto certificate = trilib::certify_pd_delaunay(tri,obj,Directions::u,Directions::v,num_threads);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	for(const auto& edge : certificate.violations){
+		std::cout<<"violation "<<edge.first<<" "<<edge.second<<"\n";
+	}
+	std::cout<<name<<" "<<(certificate.violations.empty() ? "certified" : "violated")<<" edges="<<certificate.edge_count
+	  <<" interior="<<certificate.interior_edge_count<<" violations="<<certificate.violations.size()<<" load_time="<<load_seconds<<" time="<<seconds<<"\n";
+	return certificate.violations.empty();
+}
 
-bool is_flippable(hE_hand edg_iter, kernel& obj){
-	if(edg_iter->is_border_edge()){ return false; }
+// Reads the vertices of a mesh in OFF format (ignoring its faces, if
+// any) into coordinates (two per vertex). Returns false on error.
+bool read_off_points(std::istream& in, std::vector<double>& coordinates){
+	std::string signature;
+	int num_vertices;
+	int num_faces;
+	int num_edges;
+	if(!(in>>signature) || (signature != "OFF") || !(in>>num_vertices>>num_faces>>num_edges) || (num_vertices < 0)){
+		std::cerr<<"not OFF format\n";
+		return false;
+	}
+	coordinates.clear();
+	for(int i = 0; i < num_vertices; ++i){
+		double x;
+		double y;
+		double z;
+		if(!(in>>x>>y>>z)){
+			std::cerr<<"cannot get vertex\n";
+			return false;
+		}
+		coordinates.insert(coordinates.end(), {x, y});
+	}
+	return true;
+}
+
+// Writes the work-list of a run of the LOP on tri: the name of its
+// schedule and its number of edges, then the two vertex indices of each
+// edge in the output written for tri (so that the run can be resumed from
+// that output). Returns false on error.
+template<class Tri>
+bool write_worklist(const std::string& path, const Tri& tri, const trilib::Lop_worklist<Tri>& worklist){
+	auto vertices = tri.output_vertices();
+	std::vector<int> position(vertices.size());
+	for(std::size_t i = 0; i < vertices.size(); ++i){ position[vertices[i]->id()] = int(i); }
+	std::vector<std::pair<int,int>> edges = trilib::edge_vertex_ids<Tri>(worklist.edges);
+	std::ofstream out(path);
+	out<<"worklist "<<trilib::schedule_name(worklist.schedule)<<" "<<edges.size()<<"\n";
+	for(const auto& edge : edges){ out<<position[edge.first]<<" "<<position[edge.second]<<"\n"; }
+	return bool(out);
+}
+
+// Reads a work-list written by write_worklist for the mesh tri (i.e., the
+// output of the run to resume). Returns false on error.
+template<class Tri>
+bool read_worklist(const std::string& path, Tri& tri, trilib::Lop_worklist<Tri>& worklist){
+	std::ifstream in(path);
+	std::string signature;
+	std::string schedule;
+	std::size_t num_edges;
+	if(!(in>>signature>>schedule>>num_edges) || (signature != "worklist") || !trilib::parse_schedule(schedule, worklist.schedule)){
+		std::cerr<<"invalid work-list\n";
+		return false;
+	}
+	std::vector<std::pair<int,int>> edges;
+	for(std::size_t i = 0; i < num_edges; ++i){
+		std::pair<int,int> edge;
+		if(!(in>>edge.first>>edge.second)){
+			std::cerr<<"invalid work-list\n";
+			return false;
+		}
+		edges.push_back(edge);
+	}
+	worklist.edges = trilib::find_edges(tri, edges);
+	return true;
+}
+
+// Runs the default mode: reads a mesh (or, with from_points, only its
+// points) from the standard input and writes its preferred-directions
+// Delaunay triangulation to the standard output, using the triangulation
+// type Tri (e.g., with float coordinates). With an anytime budget, the
+// LOP may stop early, in which case the (valid but not yet
+// preferred-directions Delaunay) triangulation is written, and the
+// edges still to be tested are reported (and saved to the work-list file).
+// With a JSON report, the time of each phase, the statistics of the LOP,
+// of the kernel and of interval arithmetic (of the main thread), and the
+// peak memory use are written to the report file (or the standard error).
+template<class Tri>
+int run_single(const Order_options& options, bool use_counters, bool from_points, unsigned num_threads, const Anytime_options& anytime,
+  const Report_options& report_options){
+	// With --counters, the time and hardware performance counters of each
+	// phase are written to the standard error, per vertex read, per edge
+	// tested and per face written, respectively.
+	trilib::perf::Counters counters;
+	if(use_counters && !counters.available()){ std::cerr<<"hardware performance counters are not available\n"; }
+	trilib::report::Report report;
+	auto run_start = std::chrono::steady_clock::now();
+	auto start = run_start;
+	auto begin_phase = [&](){
+		if(use_counters){ counters.start(); }
+		start = std::chrono::steady_clock::now();
+	};
+	auto end_phase = [&](const char* name, double operations, bool reported = true){
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if(report_options.json && reported){ report.set("phase_seconds", name, seconds); }
+		if(!use_counters){ return; }
+		trilib::perf::Sample sample = counters.stop();
+		std::cerr<<"phase "<<name<<" time="<<seconds<<"s"<<trilib::perf::format_per_operation(sample, operations)<<"\n";
+	};
+
+	// The input is decompressed (if needed) on a separate thread.
+	trilib::io::Input_stream in(std::cin);
+	auto report_input_error = [](const trilib::io::Input_stream& in){
+		if(!in.error().empty()){ std::cerr<<"cannot read the input ("<<in.error()<<")\n"; }
+	};
+	Tri tri;
+	configure(tri, options);
+	tri.set_num_threads(int(num_threads));
+	kernel obj;
+	trilib::Lop_statistics lop{0,0,0};
+	trilib::Lop_worklist<Tri> worklist;
+	worklist.schedule = options.schedule;
+	bool complete = true;
+	if(from_points){
+		// Build the triangulation of the vertices of the input by divide
+		// and conquer (the faces of the input, if any, are ignored).
+		std::vector<double> coordinates;
+		begin_phase();
+		if(!read_off_points(in, coordinates) || !in.read_to_end()){
+			report_input_error(in);
+			return 1;
+		}
+		end_phase("parse", coordinates.size() / 2);
+		tri.set_validation(trilib::Validation::trusted);
+		begin_phase();
+		if(!trilib::dc_pd_delaunay(tri,obj,Directions::u,Directions::v,coordinates.data(),int(coordinates.size() / 2),num_threads,&lop)){
+			std::cerr<<"cannot triangulate the points (duplicate or collinear points)\n";
+			return 1;
+		}
+		end_phase("divide_and_conquer", coordinates.size() / 2);
+	}
 	else{
-		point a = edg_iter->vertex()->point();
-		point b = edg_iter->next()->vertex()->point();
-		point c = edg_iter->opposite()->vertex()->point();
-		point d = edg_iter->opposite()->next()->vertex()->point();
-		return (obj.is_strictly_convex_quad(a,b,c,d));
+		begin_phase();
+		if(!tri.input_off(in) || !in.read_to_end()){
+			report_input_error(in);
+			return 1;
+		}
+		// The report has the input phase split into its parts (instead of
+		// their sum, which would be counted twice in a sum of the phases).
+		end_phase("input", tri.size_of_vertices(), false);
+		if(report_options.json){
+			report.set("phase_seconds", "parse", tri.input_times().parse_seconds);
+			report.set("phase_seconds", "build", tri.input_times().build_seconds);
+			report.set("phase_seconds", "validate", tri.input_times().validate_seconds);
+		}
+		trilib::Lop_budget budget = anytime.budget;
+		if(anytime.report_progress){
+			budget.progress = [](const trilib::Lop_progress& progress){
+				std::cerr<<"progress flips="<<progress.flip_count<<" tests="<<progress.test_count
+				  <<" remaining="<<progress.remaining_count<<" time="<<progress.seconds<<"s\n";
+				return true;
+			};
+		}
+		if(!anytime.resume_path.empty()){
+			begin_phase();
+			if(!read_worklist(anytime.resume_path, tri, worklist)){ return 1; }
+			lop.suspect_push_count += worklist.edges.size();
+			end_phase("scan", worklist.edges.size());
+			begin_phase();
+			complete = trilib::resume_pd_delaunay_lop(tri,obj,Directions::u,Directions::v,budget,worklist,lop);
+			end_phase("lop", lop.test_count);
+		}
+		else{
+			// The steps of pd_delaunay_lop, timed separately (but with
+			// the budget covering both).
+			auto budget_start = std::chrono::steady_clock::now();
+			begin_phase();
+			trilib::collect_suspect_edges(tri,obj,options.schedule,worklist.edges,lop);
+			end_phase("scan", tri.size_of_edges());
+			begin_phase();
+			complete = trilib::run_schedule(tri,obj,Directions::u,Directions::v,options.schedule,worklist.edges,lop,
+			  anytime.active() ? &budget : nullptr, budget_start);
+			end_phase("lop", lop.test_count);
+		}
+		if(!complete){
+			std::cerr<<"lop stopped flips="<<lop.flip_count<<" tests="<<lop.test_count<<" remaining="<<worklist.edges.size()<<"\n";
+		}
+		if(!anytime.worklist_path.empty() && !write_worklist(anytime.worklist_path, tri, worklist)){
+			std::cerr<<"cannot write the work-list\n";
+			return 1;
+		}
 	}
+	begin_phase();
+	trilib::io::Output_stream out(std::cout, options.compression, options.compression_level);
+	bool written = tri.output_off(out) && out.close();
+	end_phase("output", tri.size_of_faces());
+	if(!written){
+		std::cerr<<"cannot write the output"<<(out.error().empty() ? "" : " ("+out.error()+")")<<"\n";
+		return 1;
+	}
+	if(ra::profile::enabled){
+		// The triangulation is written to the standard output.
+		ra::profile::Allocation_statistics alloc_stat;
+		ra::profile::get_statistics(alloc_stat);
+		ra::profile::print_statistics(std::cerr, alloc_stat);
+	}
+	if(report_options.json){
+		report.set("run", "mode", from_points ? "from_points" : "mesh");
+		report.set("run", "schedule", trilib::schedule_name(options.schedule));
+		report.set("run", "coordinates", (sizeof(typename Tri::Kernel::FT) < sizeof(double)) ? "float" : "double");
+		report.set("run", "vertex_cache", options.vertex_cache);
+		report.set("run", "input_compression", trilib::io::compression_name(in.compression()));
+		report.set("run", "output_compression", trilib::io::compression_name(options.compression));
+		report.set("run", "complete", complete);
+		report.set("run", "total_seconds", std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count());
+		report.set("mesh", "vertices", std::size_t(tri.size_of_vertices()));
+		report.set("mesh", "faces", std::size_t(tri.size_of_faces()));
+		report.set("mesh", "edges", std::size_t(tri.size_of_edges()));
+		report.set("lop", "flips", lop.flip_count);
+		report.set("lop", "suspect_pushes", lop.suspect_push_count);
+		report.set("lop", "tests", lop.test_count);
+		report.set("lop", "remaining", worklist.edges.size());
+		kernel::Statistics kernel_stat;
+		kernel::get_statistics(kernel_stat);
+		trilib::report::add_kernel_statistics<double>(report, kernel_stat);
+		ra::math::interval<double>::statistics interval_stat;
+		ra::math::interval<double>::get_statistics(interval_stat);
+		trilib::report::add_interval_statistics<double>(report, interval_stat);
+		std::size_t peak_rss = trilib::report::peak_rss_bytes();
+		report.set("memory", "peak_rss_bytes", peak_rss);
+		report.set("memory", "bytes_per_triangle", (tri.size_of_faces() > 0) ? double(peak_rss) / tri.size_of_faces() : 0.0);
+		if(report_options.path.empty()){ report.write_json(std::cerr); }
+		else{
+			std::ofstream out(report_options.path);
+			report.write_json(out);
+			if(!out){
+				std::cerr<<"cannot write the report\n";
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+void usage(){
+	std::cerr<<"usage: delaunay_triangulation < input.off > output.off\n"
+	  <<"       delaunay_triangulation --batch output_dir [--threads n] [--manifest file] [input.off...]\n"
+	  <<"       delaunay_triangulation --serve socket_path|-\n"
+	  <<"       delaunay_triangulation --verify [--threads n] [input.off...]\n"
+	  <<"       delaunay_triangulation --from-points [--threads n] < points.off > output.off\n"
+	  <<"       delaunay_triangulation [--max-flips n] [--max-seconds s] [--progress] [--worklist file] [--resume file] < input.off > output.off\n"
+	  <<"options: --spatial-sort (store the mesh along a Hilbert curve; off by default, gain unmeasured with CGAL)\n"
+	  <<"         --storage-order (write vertices in storage order, not input order)\n"
+	  <<"         --schedule lifo|fifo|spatial|priority (order of the suspect edges of the LOP)\n"
+	  <<"         --validation full|topology|trusted (checks of the input mesh; trusted is for meshes we wrote;\n"
+	  <<"           below full, the faces must be CCW and the border convex, or the output is meaningless;\n"
+	  <<"           --serve requires full)\n"
+	  <<"         --threads n (threads of --batch, --verify and --from-points, and of the orientation checks\n"
+	  <<"           of full validation; all cores by default)\n"
+	  <<"         --vertex-cache (cache the values of the kernel tests per vertex, for the LOP)\n"
+	  <<"         --float (store the coordinates as float; the input is rounded to float)\n"
+	  <<"         --counters (report the hardware performance counters of each phase to stderr)\n"
+	  <<"         --max-flips n, --max-seconds s (stop the LOP early; the output is then valid but not yet pd-Delaunay)\n"
+	  <<"         --progress (report the progress of the LOP to stderr)\n"
+	  <<"         --worklist file (write the edges left to test, for --resume)\n"
+	  <<"         --resume file (resume the LOP on the output of a stopped run from its work-list)\n"
+	  <<"         --compress none|gzip|zstd (compress the output; compressed input is detected)\n"
+	  <<"         --compression-level n (with --compress: 1-9 for gzip, 1-19 for zstd, 0 or omitted for the default level)\n"
+	  <<"         --report json, --report=json (write the phase times, statistics and peak memory of the run to stderr)\n"
+	  <<"         --report-file file (write the report to a file instead)\n";
 }
 
 int main(int argc, char** argv){
 	using std::cout;
 	using std::endl;
-	Triangulation tri(std::cin);
-	kernel obj;
-	hE_hand tmp_hand;
-
-	
-	std::vector<hE_hand> suspect_list;
-	for (auto halfedgeIter = tri.halfedges_begin(); halfedgeIter !=tri.halfedges_end(); ++++halfedgeIter) {
-		tmp_hand = &*halfedgeIter;
-		if(is_flippable(tmp_hand,obj)){
-			suspect_list.push_back(tmp_hand);
-		}
-	}
-
-	while(!(suspect_list.empty())){
-		hE_hand  it = suspect_list.back();
-		if(is_flippable(it,obj)){
-			point c = it->vertex()->point();
-			point d = it->next()->vertex()->point();
-			point a = it->opposite()->vertex()->point();
-			point b = it->opposite()->next()->vertex()->point();
-			if(!(obj.is_locally_pd_delaunay_edge(a,b,c,d,vector(1,0),vector(1,1)))){
-				it = tri.flip_edge(it);
-				suspect_list.push_back(it->next());
-				suspect_list.push_back(it->next()->next());
-				suspect_list.push_back(it->opposite()->next());
-				suspect_list.push_back(it->opposite()->next()->next());
+	std::string batch_dir;
+	std::string service_path;
+	bool verify_only = false;
+	bool use_counters = false;
+	bool from_points = false;
+	bool use_float = false;
+	Order_options options{false, false, trilib::Schedule::lifo, trilib::Validation::full, false,
+	  trilib::io::Compression::none, 0};
+	Anytime_options anytime{trilib::Lop_budget(), false, "", ""};
+	Report_options report{false, ""};
+	std::vector<std::string> inputs;
+	// The compression level is checked against the format once every
+	// argument has been read.
+	const char* compression_level = nullptr;
+	unsigned num_threads = std::max(1u, std::thread::hardware_concurrency());
+	for(int i = 1; i < argc; ++i){
+		std::string arg(argv[i]);
+		if( (arg == "--batch") && (i+1 < argc) ){ batch_dir = argv[++i]; }
+		else if( (arg == "--serve") && (i+1 < argc) ){ service_path = argv[++i]; }
+		else if(arg == "--verify"){ verify_only = true; }
+		else if(arg == "--counters"){ use_counters = true; }
+		else if(arg == "--from-points"){ from_points = true; }
+		else if(arg == "--float"){ use_float = true; }
+		else if( (arg == "--max-flips") && (i+1 < argc) ){ anytime.budget.max_flips = std::strtoull(argv[++i], nullptr, 10); }
+		else if( (arg == "--max-seconds") && (i+1 < argc) ){ anytime.budget.max_seconds = std::atof(argv[++i]); }
+		else if(arg == "--progress"){ anytime.report_progress = true; }
+		else if( (arg == "--worklist") && (i+1 < argc) ){ anytime.worklist_path = argv[++i]; }
+		else if( (arg == "--resume") && (i+1 < argc) ){ anytime.resume_path = argv[++i]; }
+		else if(arg == "--report=json"){ report.json = true; }
+		else if( (arg == "--report") && (i+1 < argc) ){
+			if(std::string(argv[++i]) != "json"){ usage(); return 2; }
+			report.json = true;
+		}
+		else if( (arg == "--report-file") && (i+1 < argc) ){ report.path = argv[++i]; }
+		else if( (arg == "--threads") && (i+1 < argc) ){ num_threads = std::atoi(argv[++i]); }
+		else if(arg == "--spatial-sort"){ options.spatial_sort = true; }
+		else if(arg == "--storage-order"){ options.storage_order = true; }
+		else if(arg == "--vertex-cache"){ options.vertex_cache = true; }
+		else if( (arg == "--compress") && (i+1 < argc) ){
+			if(!trilib::io::parse_compression(argv[++i], options.compression)){ usage(); return 2; }
+			if(!trilib::io::is_available(options.compression)){
+				std::cerr<<trilib::io::compression_name(options.compression)<<" support is not compiled in\n";
+				return 2;
 			}
 		}
-		suspect_list.pop_back();
+		else if( (arg == "--compression-level") && (i+1 < argc) ){ compression_level = argv[++i]; }
+		else if( (arg == "--schedule") && (i+1 < argc) ){
+			if(!trilib::parse_schedule(argv[++i], options.schedule)){ usage(); return 2; }
+		}
+		else if( (arg == "--validation") && (i+1 < argc) ){
+			std::string level(argv[++i]);
+			if(level == "full"){ options.validation = trilib::Validation::full; }
+			else if(level == "topology"){ options.validation = trilib::Validation::topology; }
+			else if(level == "trusted"){ options.validation = trilib::Validation::trusted; }
+			else{ usage(); return 2; }
+		}
+		else if( (arg == "--manifest") && (i+1 < argc) ){
+			std::ifstream manifest(argv[++i]);
+			std::string name;
+			while(std::getline(manifest, name)){
+				if(!name.empty()){ inputs.push_back(name); }
+			}
+		}
+		else if( (arg.size() > 1) && (arg[0] == '-') ){ usage(); return 2; }
+		else{ inputs.push_back(arg); }
+	}
+	if(!report.path.empty() && !report.json){ usage(); return 2; }
+	if(compression_level){
+		if(options.compression == trilib::io::Compression::none){ usage(); return 2; }
+		if(!trilib::io::parse_compression_level(compression_level, options.compression, options.compression_level)){
+			std::cerr<<"the compression level of "<<trilib::io::compression_name(options.compression)<<" is from 1 to "
+			  <<trilib::io::max_compression_level(options.compression)<<" (or 0 for the default)\n";
+			return 2;
+		}
+	}
+	if( (options.compression != trilib::io::Compression::none) && (!service_path.empty() || verify_only) ){ usage(); return 2; }
+	if( (from_points || use_float || anytime.active() || report.json) && (!service_path.empty() || verify_only || !batch_dir.empty()) ){ usage(); return 2; }
+	if(from_points && anytime.active()){ usage(); return 2; }
+	if(!service_path.empty()){
+		if(!batch_dir.empty() || !inputs.empty()){ usage(); return 2; }
+		// The meshes of the clients are not trusted
+		if(options.validation != trilib::Validation::full){ usage(); return 2; }
+		return options.vertex_cache ? run_service<Cached_triangulation>(service_path, options) : run_service<Triangulation>(service_path, options);
 	}
+	if(verify_only){
+		if(!batch_dir.empty()){ usage(); return 2; }
+		auto verify_with = options.vertex_cache ? &verify<Cached_triangulation> : &verify<Triangulation>;
+		bool ok = true;
+		for(const std::string& name : inputs){
+			std::ifstream in(name, std::ios::binary);
+			ok = verify_with(in, name, num_threads, options) && ok;
+		}
+		if(inputs.empty()){ ok = verify_with(std::cin, "-", num_threads, options); }
+		return ok ? 0 : 1;
+	}
+	if(!batch_dir.empty()){
+		std::filesystem::create_directories(batch_dir);
+		return options.vertex_cache ? run_batch<Cached_triangulation>(inputs, batch_dir, num_threads, options) :
+		  run_batch<Triangulation>(inputs, batch_dir, num_threads, options);
+	}
+	if(!inputs.empty()){ usage(); return 2; }
 
-	tri.output_off(cout);
-	
+	if(use_float){
+		return options.vertex_cache ? run_single<Cached_float_triangulation>(options, use_counters, from_points, num_threads, anytime, report) :
+		  run_single<Float_triangulation>(options, use_counters, from_points, num_threads, anytime, report);
+	}
+	return options.vertex_cache ? run_single<Cached_triangulation>(options, use_counters, from_points, num_threads, anytime, report) :
+	  run_single<Triangulation>(options, use_counters, from_points, num_threads, anytime, report);
 }
 
 
 
 
+
 /*
 OFF
 5 4 0
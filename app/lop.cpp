@@ -0,0 +1,88 @@
+#include<chrono>
+#include<limits>
+#include <CGAL/Simple_cartesian.h>
+#include"ra/kernel.hpp"
+#include"trilib/lop.hpp"
+#include"triangulation_2.hpp"
+#include"pd_delaunay.hpp"
+
+namespace trilib {
+
+	namespace {
+		using Kernel = CGAL::Simple_cartesian<double>;
+		using kernel = ra::geometry::Kernel<double>;
+		using Triangulation = Triangulation_2<Kernel>;
+		using vector = Kernel::Vector_2;
+
+		double seconds_since(std::chrono::steady_clock::time_point start){
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+	}
+
+	Lop_result pd_delaunay_triangulate(span<const double> coordinates, span<const std::int32_t> faces,
+	  span<std::int32_t> result_faces, const Lop_options& options, span<std::int32_t> remaining_edges){
+		Lop_result result{};
+		result.ok = false;
+		constexpr std::size_t max_count = std::numeric_limits<int>::max();
+		if( (coordinates.size() % 2 != 0) || (faces.size() % 3 != 0) || (result_faces.size() != faces.size()) ||
+		  (coordinates.size() / 2 > max_count) || (faces.size() / 3 > max_count) || (options.resume_edges.size() % 2 != 0) ){
+			return result;
+		}
+		auto start = std::chrono::steady_clock::now();
+		Triangulation tri;
+		tri.set_spatial_sort(options.spatial_sort);
+		tri.set_validation(options.validation);
+		if(!tri.input_arrays(coordinates.data(), int(coordinates.size() / 2), faces.data(), int(faces.size() / 3))){
+			return result;
+		}
+		if( (remaining_edges.size() > 0) && (remaining_edges.size() < 2 * std::size_t(tri.size_of_edges())) ){ return result; }
+		result.build_seconds = seconds_since(start);
+		start = std::chrono::steady_clock::now();
+		// The kernel statistics of the calling thread are left running, so
+		// the counts of this run are the differences.
+		kernel obj;
+		kernel::Statistics before;
+		kernel::get_statistics(before);
+		vector u(options.u[0], options.u[1]);
+		vector v(options.v[0], options.v[1]);
+		Lop_statistics lop{0,0,0};
+		Lop_worklist<Triangulation> worklist;
+		if(options.resume){
+			std::vector<std::pair<int,int>> edges;
+			edges.reserve(options.resume_edges.size() / 2);
+			for(std::size_t i = 0; i < options.resume_edges.size(); i += 2){
+				edges.push_back(std::make_pair(options.resume_edges[i], options.resume_edges[i + 1]));
+			}
+			worklist.schedule = options.schedule;
+			worklist.edges = find_edges(tri, edges);
+			lop.suspect_push_count += worklist.edges.size();
+			result.complete = resume_pd_delaunay_lop(tri, obj, u, v, options.budget, worklist, lop);
+		}
+		else{
+			result.complete = pd_delaunay_lop(tri, obj, u, v, options.schedule, options.budget, worklist, lop);
+		}
+		result.lop_seconds = seconds_since(start);
+		std::vector<std::pair<int,int>> remaining = edge_vertex_ids<Triangulation>(worklist.edges);
+		result.remaining_count = remaining.size();
+		if(remaining_edges.size() > 0){
+			for(std::size_t i = 0; i < remaining.size(); ++i){
+				remaining_edges[2 * i] = remaining[i].first;
+				remaining_edges[2 * i + 1] = remaining[i].second;
+			}
+		}
+		tri.output_faces(result_faces.data());
+		kernel::Statistics st;
+		kernel::get_statistics(st);
+		result.ok = true;
+		result.flip_count = lop.flip_count;
+		result.suspect_push_count = lop.suspect_push_count;
+		result.test_count = lop.test_count;
+		result.flippable_quad_total_count = st.flippable_quad_total_count - before.flippable_quad_total_count;
+		result.flippable_quad_exact_count = st.flippable_quad_exact_count - before.flippable_quad_exact_count;
+		result.locally_pd_delaunay_edge_total_count = st.locally_pd_delaunay_edge_total_count - before.locally_pd_delaunay_edge_total_count;
+		result.locally_pd_delaunay_edge_exact_count = st.locally_pd_delaunay_edge_exact_count - before.locally_pd_delaunay_edge_exact_count;
+		result.locally_pd_delaunay_edge_tie_count = st.locally_pd_delaunay_edge_tie_count - before.locally_pd_delaunay_edge_tie_count;
+		return result;
+	}
+
+}
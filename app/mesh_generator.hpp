@@ -0,0 +1,124 @@
+#ifndef MESH_GENERATOR_HPP
+#define MESH_GENERATOR_HPP
+#include<algorithm>
+#include<array>
+#include<cstdint>
+#include<random>
+#include<vector>
+#include"ra/kernel.hpp"
+
+// Generators of the meshes of the benchmarks and tests, as the arrays of
+// Triangulation_2::input_arrays.
+namespace trilib::generator {
+
+	// The coordinates (x and y of each vertex) and faces (three vertex
+	// indices of each face, in CCW order) of a mesh.
+	struct Mesh {
+		std::vector<double> coordinates;
+		std::vector<std::int32_t> faces;
+		int num_vertices() const { return int(coordinates.size() / 2); }
+		int num_faces() const { return int(faces.size() / 3); }
+	};
+
+	// Makes an n by n grid of points, with each cell split along a random
+	// diagonal. The interior points are moved from the integer grid by up
+	// to jitter in each coordinate (so every cell stays convex if jitter
+	// is below 0.25). Each cell's diagonal is flipped at most once by the
+	// LOP.
+	inline Mesh make_grid_mesh(int n, double jitter, unsigned seed){
+		std::mt19937_64 gen(seed);
+		std::uniform_real_distribution<double> offset(-jitter, jitter);
+		Mesh mesh;
+		for(int i = 0; i < n; ++i){
+			for(int j = 0; j < n; ++j){
+				bool border = (i == 0) || (j == 0) || (i + 1 == n) || (j + 1 == n);
+				bool moved = (jitter > 0) && !border;
+				mesh.coordinates.push_back(i + (moved ? offset(gen) : 0.0));
+				mesh.coordinates.push_back(j + (moved ? offset(gen) : 0.0));
+			}
+		}
+		for(int i = 0; i + 1 < n; ++i){
+			for(int j = 0; j + 1 < n; ++j){
+				std::int32_t v00 = i*n + j;
+				std::int32_t v10 = (i+1)*n + j;
+				std::int32_t v11 = (i+1)*n + j + 1;
+				std::int32_t v01 = i*n + j + 1;
+				if(gen() & 1){
+					mesh.faces.insert(mesh.faces.end(), {v00, v10, v11, v00, v11, v01});
+				}
+				else{
+					mesh.faces.insert(mesh.faces.end(), {v00, v10, v01, v10, v11, v01});
+				}
+			}
+		}
+		return mesh;
+	}
+
+	// Makes a triangulation of n random points in the unit square (and its
+	// four corners) by sweeping them in the order of x: each point is joined
+	// to the edges of the convex hull of the previous points that it sees.
+	// The faces are long and thin, and the flips of the LOP interact: there
+	// are more flips than edges (e.g., about 8n for n = 10^4), and their
+	// number depends on the schedule, unlike on a grid, where each cell is
+	// flipped at most once.
+	inline Mesh make_sweep_mesh(int n, unsigned seed){
+		struct Point {
+			double x_, y_;
+			double x() const { return x_; }
+			double y() const { return y_; }
+		};
+		using Orientation = ra::geometry::Kernel<double>::Orientation;
+		std::mt19937_64 gen(seed);
+		std::uniform_real_distribution<double> coordinate(0.0, 1.0);
+		std::vector<Point> points{{0,0}, {0,1}, {1,0}, {1,1}};
+		for(int i = 0; i < n; ++i){ points.push_back({coordinate(gen), coordinate(gen)}); }
+		std::vector<std::int32_t> order(points.size());
+		for(std::size_t i = 0; i < order.size(); ++i){ order[i] = std::int32_t(i); }
+		std::sort(order.begin(), order.end(), [&points](std::int32_t a, std::int32_t b){
+			return (points[a].x_ < points[b].x_) || ( (points[a].x_ == points[b].x_) && (points[a].y_ < points[b].y_) );
+		});
+		Mesh mesh;
+		for(const Point& p : points){
+			mesh.coordinates.push_back(p.x_);
+			mesh.coordinates.push_back(p.y_);
+		}
+		// The lower and upper chains of the convex hull of the swept points,
+		// both from the leftmost to the last point
+		ra::geometry::Kernel<double> obj;
+		std::vector<std::int32_t> lower{order[0], order[1]};
+		std::vector<std::int32_t> upper{order[0], order[1]};
+		for(std::size_t i = 2; i < order.size(); ++i){
+			std::int32_t p = order[i];
+			while( (lower.size() > 1) && (obj.orientation(points[lower[lower.size()-2]], points[lower.back()], points[p]) == Orientation::right_turn) ){
+				mesh.faces.insert(mesh.faces.end(), {lower[lower.size()-2], p, lower.back()});
+				lower.pop_back();
+			}
+			lower.push_back(p);
+			while( (upper.size() > 1) && (obj.orientation(points[upper[upper.size()-2]], points[upper.back()], points[p]) == Orientation::left_turn) ){
+				mesh.faces.insert(mesh.faces.end(), {upper[upper.size()-2], upper.back(), p});
+				upper.pop_back();
+			}
+			upper.push_back(p);
+		}
+		return mesh;
+	}
+
+	// Gets the faces of the triangulation as sorted triples of vertex ids,
+	// each rotated so that the smallest id is first (e.g., to compare the
+	// results of different algorithms, which number the faces differently).
+	template<class Triangulation>
+	std::vector<std::array<int,3>> sorted_faces(Triangulation& tri){
+		std::vector<std::array<int,3>> result;
+		for(auto f = tri.faces_begin(); f != tri.faces_end(); ++f){
+			auto h = f->halfedge();
+			std::array<int,3> t{int(h->vertex()->id()), int(h->next()->vertex()->id()), int(h->next()->next()->vertex()->id())};
+			std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+			result.push_back(t);
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+}
+
+#endif // MESH_GENERATOR_HPP
@@ -0,0 +1,756 @@
+#ifndef PD_DELAUNAY_HPP
+#define PD_DELAUNAY_HPP
+#include<cstddef>
+#include<cstdint>
+#include<vector>
+#include<deque>
+#include<queue>
+#include<string>
+#include<limits>
+#include<algorithm>
+#include<utility>
+#include<chrono>
+#include<thread>
+#include"ra/kernel.hpp"
+#include"ra/alloc_profile.hpp"
+#include"trilib/lop.hpp"
+#include"triangulation_2.hpp"
+
+namespace trilib {
+
+	// The statistics of a run of the LOP.
+	struct Lop_statistics {
+		// The number of edge flips performed.
+		std::size_t flip_count;
+		// The number of edges pushed onto the suspect list.
+		std::size_t suspect_push_count;
+		// The number of suspect edges tested.
+		std::size_t test_count;
+	};
+
+	// Gets the name of a schedule.
+	inline const char* schedule_name(Schedule schedule){
+		switch(schedule){
+			case Schedule::fifo: return "fifo";
+			case Schedule::spatial: return "spatial";
+			case Schedule::priority: return "priority";
+			default: return "lifo";
+		}
+	}
+
+	// Parses the name of a schedule. Returns false if the name is unknown.
+	inline bool parse_schedule(const std::string& name, Schedule& schedule){
+		for(Schedule s : {Schedule::lifo, Schedule::fifo, Schedule::spatial, Schedule::priority}){
+			if(name == schedule_name(s)){
+				schedule = s;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Tests if the edge of the halfedge h is flippable (i.e., it has two
+	// incident faces whose union is a strictly convex quadrilateral).
+	template<class Tri, class K>
+	bool is_flippable(typename Tri::Halfedge_handle h, const K& kernel){
+		if(h->is_border_edge()){ return false; }
+		else{
+			const typename Tri::Point& a = h->vertex()->point();
+			const typename Tri::Point& b = h->next()->vertex()->point();
+			const typename Tri::Point& c = h->opposite()->vertex()->point();
+			const typename Tri::Point& d = h->opposite()->next()->vertex()->point();
+			return (kernel.is_flippable_quad(a,b,c,d));
+		}
+	}
+
+	// Estimates how far the quadrilateral of the edge of the halfedge h
+	// violates the incircle test, which is positive if the edge must be
+	// flipped. The incircle determinant grows as the fourth power of the
+	// size of the quadrilateral, so that a large quadrilateral would come
+	// before a small one that violates the test more. It is divided by the
+	// product of the squared lengths of the two diagonals, which grows as
+	// the size does, so that the key only depends on the shape of the
+	// quadrilateral. It is only used to order the suspect edges, so it is
+	// evaluated with floating-point arithmetic.
+	template<class Tri, class K>
+	double incircle_excess(typename Tri::Halfedge_handle h){
+		if(h->is_border_edge()){ return -std::numeric_limits<double>::infinity(); }
+		const typename Tri::Point& c = h->vertex()->point();
+		const typename Tri::Point& d = h->next()->vertex()->point();
+		const typename Tri::Point& a = h->opposite()->vertex()->point();
+		const typename Tri::Point& b = h->opposite()->next()->vertex()->point();
+		auto q = K::template make_quad_differences<double>(a,b,c,d);
+		double matrix[3][3] = {q.adx,q.ady,(q.adx*q.adx)+(q.ady*q.ady),q.bdx,q.bdy,(q.bdx*q.bdx)+(q.bdy*q.bdy),q.cdx,q.cdy,(q.cdx*q.cdx)+(q.cdy*q.cdy)};
+		double acx = q.cdx - q.adx;
+		double acy = q.cdy - q.ady;
+		double diagonals = ((acx*acx) + (acy*acy)) * ((q.bdx*q.bdx) + (q.bdy*q.bdy));
+		double det = K::determinant_3_by_3(matrix);
+		return (diagonals > 0.0) ? (det / diagonals) : det;
+	}
+
+	// The suspect lists of the schedules. Each provides empty, size, push
+	// and pop. The stack is kept in a vector of the caller, and the others
+	// provide save, which appends their edges to a vector in an order that
+	// restores the list when they are pushed again in turn.
+	template<class Tri>
+	class Suspect_stack {
+		public:
+			explicit Suspect_stack(std::vector<typename Tri::Halfedge_handle>& list) : list_(list) {}
+			bool empty() const { return list_.empty(); }
+			std::size_t size() const { return list_.size(); }
+			void push(typename Tri::Halfedge_handle h){ list_.push_back(h); }
+			typename Tri::Halfedge_handle pop(){
+				typename Tri::Halfedge_handle h = list_.back();
+				list_.pop_back();
+				return h;
+			}
+		private:
+			std::vector<typename Tri::Halfedge_handle>& list_;
+	};
+
+	template<class Tri>
+	class Suspect_queue {
+		public:
+			bool empty() const { return list_.empty(); }
+			std::size_t size() const { return list_.size(); }
+			void push(typename Tri::Halfedge_handle h){ list_.push_back(h); }
+			typename Tri::Halfedge_handle pop(){
+				typename Tri::Halfedge_handle h = list_.front();
+				list_.pop_front();
+				return h;
+			}
+			void save(std::vector<typename Tri::Halfedge_handle>& list) const { list.insert(list.end(), list_.begin(), list_.end()); }
+		private:
+			std::deque<typename Tri::Halfedge_handle> list_;
+	};
+
+	// The priority of an edge is computed when it is pushed. Since a flip
+	// only changes the edges it pushes again, a stale priority only
+	// affects the order in which an edge is tested and not the result.
+	template<class Tri, class K>
+	class Suspect_heap {
+		public:
+			bool empty() const { return heap_.empty(); }
+			std::size_t size() const { return heap_.size(); }
+			void push(typename Tri::Halfedge_handle h){ heap_.push(Entry{incircle_excess<Tri,K>(h), h}); }
+			typename Tri::Halfedge_handle pop(){
+				typename Tri::Halfedge_handle h = heap_.top().halfedge;
+				heap_.pop();
+				return h;
+			}
+			void save(std::vector<typename Tri::Halfedge_handle>& list){
+				while(!heap_.empty()){ list.push_back(pop()); }
+			}
+		private:
+			struct Entry {
+				double excess;
+				typename Tri::Halfedge_handle halfedge;
+				bool operator<(const Entry& other) const { return excess < other.excess; }
+			};
+			std::priority_queue<Entry> heap_;
+	};
+
+	// Tests if the interior edge of the halfedge it must be flipped to
+	// make it locally pd-Delaunay. If the triangulation has the vertex
+	// cache, the cached values of the vertices are passed to the kernel
+	// instead of their points.
+	template<class Tri, class K, class U, class V>
+	bool edge_needs_pd_flip(const Tri&, const K& kernel, typename Tri::Halfedge_const_handle it, const U& u, const V& v){
+		if constexpr(Tri::vertex_cache()){
+			return kernel.needs_pd_flip(it->opposite()->vertex()->cached_point(), it->opposite()->next()->vertex()->cached_point(),
+			  it->vertex()->cached_point(), it->next()->vertex()->cached_point(), u, v);
+		}
+		return kernel.needs_pd_flip(it->opposite()->vertex()->point(), it->opposite()->next()->vertex()->point(),
+		  it->vertex()->point(), it->next()->vertex()->point(), u, v);
+	}
+
+	// Applies the LOP to the edges of the suspect list (and to the edges
+	// affected by their flips) until the list is empty, in the order of
+	// the suspect list, or until the budget (if not null) is exhausted.
+	// The time of the budget is counted from start (e.g., before the
+	// suspect list was collected), and it is checked before the first test
+	// and then every progress_interval tests.
+	// Returns true if the list is empty; otherwise the edges left on it are
+	// those still to be tested.
+	template<class Tri, class K, class U, class V, class List>
+	bool run_lop(Tri& tri, const K& kernel, const U& u, const V& v,
+	  List& suspect_list, Lop_statistics& stat, const Lop_budget* budget = nullptr,
+	  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now()){
+		using Halfedge_handle = typename Tri::Halfedge_handle;
+		RA_ALLOC_SCOPE(ra::profile::Region::flip);
+		std::size_t max_flip_count = std::numeric_limits<std::size_t>::max();
+		std::size_t next_check = std::numeric_limits<std::size_t>::max();
+		if(budget){
+			if(budget->max_flips > 0){ max_flip_count = stat.flip_count + budget->max_flips; }
+			if( (budget->max_seconds > 0.0) || budget->progress ){ next_check = stat.test_count; }
+		}
+		while(!(suspect_list.empty())){
+			if(stat.flip_count >= max_flip_count){ return false; }
+			if(budget && (stat.test_count >= next_check)){
+				next_check = stat.test_count + std::max<std::size_t>(1, budget->progress_interval);
+				double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				if( (budget->max_seconds > 0.0) && (seconds >= budget->max_seconds) ){ return false; }
+				if( budget->progress && !budget->progress(Lop_progress{stat.flip_count, stat.test_count, suspect_list.size(), seconds}) ){
+					return false;
+				}
+			}
+			Halfedge_handle it = suspect_list.pop();
+			if(!(it->is_border_edge())){
+				++(stat.test_count);
+				if(edge_needs_pd_flip(tri,kernel,it,u,v)){
+					it = tri.flip_edge(it);
+					++(stat.flip_count);
+					suspect_list.push(it->next());
+					suspect_list.push(it->next()->next());
+					suspect_list.push(it->opposite()->next());
+					suspect_list.push(it->opposite()->next()->next());
+					stat.suspect_push_count += 4;
+				}
+			}
+		}
+		return true;
+	}
+
+	// Applies the LOP to the edges of the suspect list (and to the edges
+	// affected by their flips) until the list is empty. Only the edges
+	// reachable from the suspect edges through flips are visited, so the
+	// cost depends on the extent of the change and not on the size of the
+	// triangulation.
+	template<class Tri, class K, class U, class V>
+	void restore_pd_delaunay(Tri& tri, const K& kernel, const U& u, const V& v,
+	  std::vector<typename Tri::Halfedge_handle>& suspect_list, Lop_statistics& stat){
+		Suspect_stack<Tri> stack(suspect_list);
+		run_lop(tri,kernel,u,v,stack,stat);
+	}
+
+	// Sorts the edges of the halfedges in list along a Hilbert curve
+	// through their midpoints, in decreasing order (so that they are
+	// popped from a stack in increasing order). This is only the seed order
+	// of the spatial schedule: the edges pushed by flips are then popped
+	// before the rest, as with lifo.
+	template<class Tri>
+	void sort_by_hilbert_index(std::vector<typename Tri::Halfedge_handle>& list){
+		if(list.empty()){ return; }
+		double x_min = list[0]->vertex()->point().x();
+		double x_max = x_min;
+		double y_min = list[0]->vertex()->point().y();
+		double y_max = y_min;
+		for(const auto& h : list){
+			for(const auto& p : {h->vertex()->point(), h->opposite()->vertex()->point()}){
+				x_min = std::min(x_min, double(p.x())); x_max = std::max(x_max, double(p.x()));
+				y_min = std::min(y_min, double(p.y())); y_max = std::max(y_max, double(p.y()));
+			}
+		}
+		double x_scale = (x_max > x_min) ? 65535.0 / (x_max - x_min) : 0.0;
+		double y_scale = (y_max > y_min) ? 65535.0 / (y_max - y_min) : 0.0;
+		std::vector<std::pair<std::uint32_t,typename Tri::Halfedge_handle>> keyed;
+		keyed.reserve(list.size());
+		for(const auto& h : list){
+			double x = (double(h->vertex()->point().x()) + double(h->opposite()->vertex()->point().x())) / 2.0;
+			double y = (double(h->vertex()->point().y()) + double(h->opposite()->vertex()->point().y())) / 2.0;
+			keyed.push_back(std::make_pair(hilbert_index(std::uint32_t((x - x_min) * x_scale), std::uint32_t((y - y_min) * y_scale)), h));
+		}
+		std::stable_sort(keyed.begin(), keyed.end(), [](const auto& i, const auto& j){ return i.first > j.first; });
+		for(std::size_t i = 0; i < keyed.size(); ++i){ list[i] = keyed[i].second; }
+	}
+
+	// The suspect edges left by a run of the LOP that exhausted its
+	// budget, from which the run can be resumed. Since a flip keeps the
+	// halfedges of the triangulation (and only changes their vertices),
+	// the handles remain valid as long as the triangulation is only
+	// changed by flips.
+	template<class Tri>
+	struct Lop_worklist {
+		// The schedule of the run.
+		Schedule schedule;
+		// The edges, in the order in which they are to be pushed again.
+		std::vector<typename Tri::Halfedge_handle> edges;
+	};
+
+	// Pushes every flippable edge of the triangulation tri onto the
+	// suspect list, in the order of schedule.
+	template<class Tri, class K>
+	void collect_suspect_edges(Tri& tri, const K& kernel, Schedule schedule, std::vector<typename Tri::Halfedge_handle>& suspect_list,
+	  Lop_statistics& stat){
+		using Halfedge_handle = typename Tri::Halfedge_handle;
+		RA_ALLOC_SCOPE(ra::profile::Region::scan);
+		for(auto halfedgeIter = tri.halfedges_begin(); halfedgeIter != tri.halfedges_end(); ++++halfedgeIter){
+			Halfedge_handle tmp_hand = &*halfedgeIter;
+			if(is_flippable<Tri>(tmp_hand,kernel)){
+				suspect_list.push_back(tmp_hand);
+				++(stat.suspect_push_count);
+			}
+		}
+		if(schedule == Schedule::spatial){ sort_by_hilbert_index<Tri>(suspect_list); }
+	}
+
+	// Applies the LOP to the edges of the suspect list (and to the edges
+	// affected by their flips) in the order of schedule, until the list is
+	// empty or the budget (if not null) is exhausted, with its time counted
+	// from start. Returns true if the list is empty; otherwise the edges
+	// left on it are put back in suspect_list.
+	template<class Tri, class K, class U, class V>
+	bool run_schedule(Tri& tri, const K& kernel, const U& u, const V& v, Schedule schedule,
+	  std::vector<typename Tri::Halfedge_handle>& suspect_list, Lop_statistics& stat, const Lop_budget* budget = nullptr,
+	  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now()){
+		using Halfedge_handle = typename Tri::Halfedge_handle;
+		if(schedule == Schedule::fifo){
+			RA_ALLOC_SCOPE(ra::profile::Region::scan);
+			Suspect_queue<Tri> queue;
+			for(Halfedge_handle h : suspect_list){ queue.push(h); }
+			suspect_list.clear();
+			if(run_lop(tri,kernel,u,v,queue,stat,budget,start)){ return true; }
+			queue.save(suspect_list);
+			return false;
+		}
+		else if(schedule == Schedule::priority){
+			RA_ALLOC_SCOPE(ra::profile::Region::scan);
+			Suspect_heap<Tri,K> heap;
+			for(Halfedge_handle h : suspect_list){ heap.push(h); }
+			suspect_list.clear();
+			if(run_lop(tri,kernel,u,v,heap,stat,budget,start)){ return true; }
+			heap.save(suspect_list);
+			return false;
+		}
+		else{
+			Suspect_stack<Tri> stack(suspect_list);
+			return run_lop(tri,kernel,u,v,stack,stat,budget,start);
+		}
+	}
+
+	// Transforms the triangulation tri into the preferred-directions
+	// Delaunay triangulation with respect to the first and second
+	// directions u and v by applying the Lawson local optimization
+	// procedure (LOP). The suspect edges are processed in the order given
+	// by schedule; the result does not depend on it. The directions may be
+	// vectors or, if they are known at compile time,
+	// ra::geometry::Fixed_direction (which reduces the tie-break).
+	template<class Tri, class K, class U, class V>
+	Lop_statistics pd_delaunay_lop(Tri& tri, const K& kernel, const U& u, const V& v,
+	  Schedule schedule = Schedule::lifo){
+		Lop_statistics stat{0,0,0};
+		std::vector<typename Tri::Halfedge_handle> suspect_list;
+		collect_suspect_edges(tri,kernel,schedule,suspect_list,stat);
+		run_schedule(tri,kernel,u,v,schedule,suspect_list,stat);
+		return stat;
+	}
+
+	// As above, but stops when the budget is exhausted, leaving a valid
+	// triangulation and the edges still to be tested in worklist (which is
+	// empty if the run is complete). The time of the budget includes the
+	// collection of the suspect edges. The statistics of the run are added
+	// to stat. Returns true if the run is complete.
+	template<class Tri, class K, class U, class V>
+	bool pd_delaunay_lop(Tri& tri, const K& kernel, const U& u, const V& v,
+	  Schedule schedule, const Lop_budget& budget, Lop_worklist<Tri>& worklist, Lop_statistics& stat){
+		auto start = std::chrono::steady_clock::now();
+		worklist.schedule = schedule;
+		worklist.edges.clear();
+		collect_suspect_edges(tri,kernel,schedule,worklist.edges,stat);
+		return run_schedule(tri,kernel,u,v,schedule,worklist.edges,stat,&budget,start);
+	}
+
+	// Resumes a run of the LOP from its work-list, within a new budget.
+	// The triangulation must not have been changed since (other than by
+	// flips). The statistics of the run are added to stat. Returns true
+	// if the run is complete.
+	template<class Tri, class K, class U, class V>
+	bool resume_pd_delaunay_lop(Tri& tri, const K& kernel, const U& u, const V& v,
+	  const Lop_budget& budget, Lop_worklist<Tri>& worklist, Lop_statistics& stat){
+		// The edges of a spatial run are already in Hilbert order.
+		Schedule schedule = (worklist.schedule == Schedule::spatial) ? Schedule::lifo : worklist.schedule;
+		return run_schedule(tri,kernel,u,v,schedule,worklist.edges,stat,&budget);
+	}
+
+	// Gets the ids of the endpoints of the edges of the halfedges in list,
+	// each edge once (e.g., to save a work-list).
+	template<class Tri>
+	std::vector<std::pair<int,int>> edge_vertex_ids(const std::vector<typename Tri::Halfedge_handle>& list){
+		std::vector<std::pair<int,int>> edges;
+		edges.reserve(list.size());
+		for(typename Tri::Halfedge_handle h : list){
+			int a = h->opposite()->vertex()->id();
+			int b = h->vertex()->id();
+			edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+		}
+		std::sort(edges.begin(), edges.end());
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+		return edges;
+	}
+
+	// Finds a halfedge of each edge given by the ids of its endpoints,
+	// which must be the input positions of the vertices of tri. The edges
+	// not in tri are skipped.
+	template<class Tri>
+	std::vector<typename Tri::Halfedge_handle> find_edges(Tri& tri, const std::vector<std::pair<int,int>>& edges){
+		using Halfedge_handle = typename Tri::Halfedge_handle;
+		std::vector<typename Tri::Vertex_handle> vertices(tri.size_of_vertices());
+		for(auto vi = tri.vertices_begin(); vi != tri.vertices_end(); ++vi){
+			if( (vi->id() >= 0) && (vi->id() < int(vertices.size())) ){ vertices[vi->id()] = &*vi; }
+		}
+		std::vector<Halfedge_handle> result;
+		result.reserve(edges.size());
+		for(const auto& edge : edges){
+			if( (edge.first < 0) || (edge.first >= int(vertices.size())) || (edge.second < 0) || (edge.second >= int(vertices.size())) ||
+			  (vertices[edge.second] == typename Tri::Vertex_handle()) ){
+				continue;
+			}
+			Halfedge_handle h = vertices[edge.second]->halfedge();
+			Halfedge_handle start = h;
+			do{
+				if(h->opposite()->vertex()->id() == edge.first){
+					result.push_back(h);
+					break;
+				}
+				h = h->next()->opposite();
+			} while(h != start);
+		}
+		return result;
+	}
+
+	// The result of a certification of the preferred-directions Delaunay
+	// property of a triangulation.
+	template<class Point>
+	struct Certificate {
+		// The number of edges tested.
+		std::size_t edge_count;
+		// The number of edges with two incident faces.
+		std::size_t interior_edge_count;
+		// The endpoints of the edges that are flippable but not locally
+		// preferred-directions Delaunay, in the storage order of the edges.
+		std::vector<std::pair<Point,Point>> violations;
+	};
+
+	// Certifies that the triangulation tri is preferred-directions
+	// Delaunay with respect to the directions u and v (i.e., that the LOP
+	// would perform no flips), by testing every interior edge with the
+	// exact predicates of the kernel. The edges are split across
+	// num_threads threads, each of which keeps its own results (and
+	// kernel statistics), so the threads do not communicate until the end,
+	// when the kernel statistics of the other threads are added to those
+	// of the calling thread.
+	template<class Tri, class K, class U, class V>
+	Certificate<typename Tri::Point> certify_pd_delaunay(const Tri& tri, const K& kernel, const U& u, const V& v, int num_threads){
+		using Point = typename Tri::Point;
+		using Halfedge_const_handle = typename Tri::Halfedge_const_handle;
+		struct Range_result {
+			std::size_t edge_count;
+			std::size_t interior_edge_count;
+			std::vector<std::pair<Point,Point>> violations;
+			// The thread of the range and its kernel statistics.
+			std::thread::id thread;
+			typename K::Statistics kernel_stat;
+		};
+		std::vector<Range_result> results(std::max(1, num_threads), Range_result{0, 0, {}, {}, K::make_stat()});
+		tri.parallel_for_each_edge([&](Halfedge_const_handle it, int i){
+			Range_result& result = results[i];
+			++(result.edge_count);
+			if(!(it->is_border_edge())){
+				++(result.interior_edge_count);
+				if(edge_needs_pd_flip(tri,kernel,it,u,v)){
+					result.violations.push_back(std::make_pair(it->opposite()->vertex()->point(), it->vertex()->point()));
+				}
+			}
+		}, [&](int i){
+			// A new thread's statistics are those of its range alone.
+			results[i].thread = std::this_thread::get_id();
+			K::get_statistics(results[i].kernel_stat);
+		}, num_threads);
+		Certificate<Point> certificate{0, 0, {}};
+		for(Range_result& result : results){
+			if( (result.thread != std::thread::id()) && (result.thread != std::this_thread::get_id()) ){
+				K::add_statistics(result.kernel_stat);
+			}
+			certificate.edge_count += result.edge_count;
+			certificate.interior_edge_count += result.interior_edge_count;
+			certificate.violations.insert(certificate.violations.end(), result.violations.begin(), result.violations.end());
+		}
+		return certificate;
+	}
+
+	// The kind of element of a triangulation that contains a point.
+	enum class Location_type { face, edge, vertex, outside };
+
+	// The result of locating a point in a triangulation.
+	template<class Tri>
+	struct Location {
+		Location_type type;
+		// A halfedge of the face or of the edge containing the point, a
+		// halfedge whose target is the vertex at the point, or, if the
+		// point is outside, a halfedge whose opposite is a border halfedge
+		// separating it from the point.
+		typename Tri::Halfedge_handle halfedge;
+	};
+
+	// Locates the point p by a visibility walk starting from the face
+	// start (or from an arbitrary face if start is null). The walk only
+	// visits faces between start and p, so locating a point near a known
+	// face is cheap. The edge of each face tested first is chosen
+	// pseudo-randomly, which guarantees that the walk terminates in any
+	// triangulation (and not only in Delaunay triangulations).
+	template<class Tri, class K>
+	Location<Tri> locate(Tri& tri, const K& kernel, const typename Tri::Point& p, typename Tri::Face_handle start = typename Tri::Face_handle()){
+		using Halfedge_handle = typename Tri::Halfedge_handle;
+		using Orientation = typename K::Orientation;
+		Halfedge_handle h = (start != typename Tri::Face_handle()) ? start->halfedge() : tri.faces_begin()->halfedge();
+		// The halfedge through which the current face was entered, for
+		// which p is known to be strictly to the left.
+		Halfedge_handle entry = Halfedge_handle();
+		unsigned seed = 0x2545f491u;
+		while(true){
+			seed = (seed * 1664525u) + 1013904223u;
+			for(unsigned i = (seed >> 16) % 3; i > 0; --i){ h = h->next(); }
+			Halfedge_handle collinear[3];
+			int num_collinear = 0;
+			bool moved = false;
+			for(int i = 0; i < 3; ++i, h = h->next()){
+				if(h == entry){ continue; }
+				Orientation o = kernel.orientation(h->opposite()->vertex()->point(), h->vertex()->point(), p);
+				if(o == Orientation::right_turn){
+					if(h->opposite()->is_border()){ return Location<Tri>{Location_type::outside, h}; }
+					entry = h->opposite();
+					h = entry;
+					moved = true;
+					break;
+				}
+				else if(o == Orientation::collinear){ collinear[num_collinear++] = h; }
+			}
+			if(!moved){
+				if(num_collinear == 0){ return Location<Tri>{Location_type::face, h}; }
+				else if(num_collinear == 1){ return Location<Tri>{Location_type::edge, collinear[0]}; }
+				else{
+					// The point is at the common vertex of the two edges.
+					Halfedge_handle a = collinear[0];
+					Halfedge_handle b = collinear[1];
+					return Location<Tri>{Location_type::vertex, (a->next() == b) ? a : b};
+				}
+			}
+		}
+	}
+
+	// Pushes the edges of the faces incident on the target of h onto the
+	// suspect list.
+	template<class Tri>
+	void push_star(typename Tri::Halfedge_handle h, std::vector<typename Tri::Halfedge_handle>& suspect_list, Lop_statistics& stat){
+		typename Tri::Halfedge_handle i = h;
+		do{
+			suspect_list.push_back(i);
+			suspect_list.push_back(i->prev());
+			stat.suspect_push_count += 2;
+			i = i->next()->opposite();
+		} while(i != h);
+	}
+
+	// Gets a face incident on the vertex vh.
+	template<class Tri>
+	typename Tri::Face_handle incident_face(typename Tri::Vertex_handle vh){
+		typename Tri::Halfedge_handle h = vh->halfedge();
+		return h->is_border() ? h->opposite()->face() : h->face();
+	}
+
+	// Inserts a vertex at the point p into the preferred-directions
+	// Delaunay triangulation tri, by splitting the face or the edge
+	// containing p, and restores the preferred-directions Delaunay
+	// property around the new vertex. The point is located starting from
+	// the face hint, so a hint near p keeps the cost of the insertion
+	// local. The statistics of the LOP are added to stat (if not null).
+	// Returns the new vertex, or a null handle if p is outside the
+	// triangulation or coincides with a vertex (in which case the
+	// triangulation is unchanged).
+	template<class Tri, class K>
+	typename Tri::Vertex_handle insert_vertex(Tri& tri, const K& kernel, const typename Tri::Vector& u, const typename Tri::Vector& v,
+	  const typename Tri::Point& p, typename Tri::Face_handle hint = typename Tri::Face_handle(), Lop_statistics* stat = nullptr){
+		using Halfedge_handle = typename Tri::Halfedge_handle;
+		Location<Tri> loc = locate(tri, kernel, p, hint);
+		Halfedge_handle h;
+		if(loc.type == Location_type::face){ h = tri.split_face(loc.halfedge->face(), p); }
+		else if(loc.type == Location_type::edge){ h = tri.split_edge(loc.halfedge, p); }
+		else{ return typename Tri::Vertex_handle(); }
+		typename Tri::Vertex_handle result = h->vertex();
+		Lop_statistics local{0,0,0};
+		std::vector<Halfedge_handle> suspect_list;
+		push_star<Tri>(h, suspect_list, local);
+		restore_pd_delaunay(tri, kernel, u, v, suspect_list, local);
+		if(stat){
+			stat->flip_count += local.flip_count;
+			stat->suspect_push_count += local.suspect_push_count;
+			stat->test_count += local.test_count;
+		}
+		return result;
+	}
+
+	// Removes the vertex vh from the preferred-directions Delaunay
+	// triangulation tri, retriangulates the polygon left by its star (and,
+	// if vh is on the border, the region between the exposed link and the
+	// new convex hull) by ear clipping, and restores the
+	// preferred-directions Delaunay property there. The statistics of the
+	// LOP are added to stat (if not null).
+	// Returns false if the vertex cannot be removed, in which case the
+	// triangulation is unchanged (since the ears are all found before it
+	// is modified). This happens if no faces would remain, or if, for an
+	// interior vertex, ear clipping stops before the polygon is reduced to
+	// a triangle: an ear must be strictly convex, with no other vertex of
+	// the polygon inside or on its triangle, and when vertices of the link
+	// are collinear, there may be no such ear (e.g., when every convex
+	// vertex has a collinear vertex on the diagonal that would cut it off).
+	template<class Tri, class K>
+	bool remove_vertex(Tri& tri, const K& kernel, const typename Tri::Vector& u, const typename Tri::Vector& v,
+	  typename Tri::Vertex_handle vh, Lop_statistics* stat = nullptr){
+		using Halfedge_handle = typename Tri::Halfedge_handle;
+		using Orientation = typename K::Orientation;
+		std::vector<Halfedge_handle> incoming;
+		std::vector<Halfedge_handle> before;
+		std::vector<Halfedge_handle> after;
+		int border = -1;
+		int num_faces = 0;
+		Halfedge_handle h = vh->halfedge();
+		do{
+			if(h->is_border()){ border = incoming.size(); }
+			else{ ++num_faces; }
+			incoming.push_back(h);
+			before.push_back(h->prev());
+			after.push_back(h->opposite()->next());
+			h = h->next()->opposite();
+		} while(h != vh->halfedge());
+
+		// Find the boundary of the polygon to be retriangulated, in the
+		// order in which it will appear once vh is erased. Each vertex of
+		// the polygon is identified by the halfedge that enters it.
+		std::vector<Halfedge_handle> polygon;
+		Halfedge_handle x = (border < 0) ? before[0] : after[border];
+		if(border >= 0){ polygon.push_back(before[border]); }
+		for(int i = 0; i < num_faces; ++i){
+			polygon.push_back(x);
+			std::size_t j = std::find(before.begin(), before.end(), x) - before.begin();
+			x = after[j];
+		}
+
+		// Find the ears to be clipped, without modifying the triangulation.
+		// For the border, only the vertices strictly inside the exposed
+		// chain can be ears, and clipping continues while the chain bends
+		// inward, which leaves the convex hull of the chain.
+		int n = polygon.size();
+		std::vector<int> prev(n);
+		std::vector<int> next(n);
+		for(int i = 0; i < n; ++i){
+			prev[i] = (i + n - 1) % n;
+			next[i] = (i + 1) % n;
+		}
+		auto point = [&polygon](int i) -> const typename Tri::Point& { return polygon[i]->vertex()->point(); };
+		auto is_ear = [&](int i){
+			if( (border >= 0) && ((i == 0) || (i == n-1)) ){ return false; }
+			int a = prev[i];
+			int c = next[i];
+			if( (border >= 0) && ((a == n-1) || (c == 0)) ){ return false; }
+			if(kernel.orientation(point(a), point(i), point(c)) != Orientation::left_turn){ return false; }
+			for(int j = next[c]; j != a; j = next[j]){
+				if( (kernel.orientation(point(a), point(i), point(j)) != Orientation::right_turn) &&
+				  (kernel.orientation(point(i), point(c), point(j)) != Orientation::right_turn) &&
+				  (kernel.orientation(point(c), point(a), point(j)) != Orientation::right_turn) ){ return false; }
+			}
+			return true;
+		};
+		std::vector<int> ears;
+		int remaining = n;
+		int first = 0;
+		while( (border >= 0) || (remaining > 3) ){
+			int ear = -1;
+			for(int i = first, j = 0; j < remaining; i = next[i], ++j){
+				if(is_ear(i)){
+					ear = i;
+					break;
+				}
+			}
+			if(ear < 0){ break; }
+			ears.push_back(ear);
+			next[prev[ear]] = next[ear];
+			prev[next[ear]] = prev[ear];
+			first = next[ear];
+			--remaining;
+		}
+		if( (border < 0) && (remaining > 3) ){ return false; }
+		if( (tri.size_of_faces() - num_faces + int(ears.size())) == 0 ){ return false; }
+
+		// Erase the vertex and clip the ears, replaying the links above.
+		std::vector<Halfedge_handle> suspect_list(polygon.begin(), polygon.end());
+		Lop_statistics local{0, polygon.size(), 0};
+		for(int i = 0; i < n; ++i){
+			prev[i] = (i + n - 1) % n;
+			next[i] = (i + 1) % n;
+		}
+		tri.erase_vertex(vh);
+		for(int ear : ears){
+			Halfedge_handle r = tri.add_edge(polygon[prev[ear]], polygon[next[ear]]);
+			polygon[next[ear]] = r;
+			next[prev[ear]] = next[ear];
+			prev[next[ear]] = prev[ear];
+			suspect_list.push_back(r);
+			++(local.suspect_push_count);
+		}
+		restore_pd_delaunay(tri, kernel, u, v, suspect_list, local);
+		if(stat){
+			stat->flip_count += local.flip_count;
+			stat->suspect_push_count += local.suspect_push_count;
+			stat->test_count += local.test_count;
+		}
+		return true;
+	}
+
+	// Moves the vertex vh of the preferred-directions Delaunay
+	// triangulation tri to the point p, and restores the
+	// preferred-directions Delaunay property. If the faces incident on vh
+	// remain correctly oriented (and, for a vertex on the border, the
+	// border remains convex), the vertex is moved in place; otherwise, an
+	// interior vertex is removed and reinserted at p. The statistics of
+	// the LOP are added to stat (if not null).
+	// Returns the moved vertex (which is a new vertex if it was
+	// reinserted), or a null handle if p is outside the triangulation,
+	// coincides with another vertex, or would make the border nonconvex
+	// (in which case the triangulation is unchanged).
+	template<class Tri, class K>
+	typename Tri::Vertex_handle move_vertex(Tri& tri, const K& kernel, const typename Tri::Vector& u, const typename Tri::Vector& v,
+	  typename Tri::Vertex_handle vh, const typename Tri::Point& p, Lop_statistics* stat = nullptr){
+		using Halfedge_handle = typename Tri::Halfedge_handle;
+		using Orientation = typename K::Orientation;
+		bool in_place = true;
+		bool on_border = false;
+		Halfedge_handle h = vh->halfedge();
+		do{
+			if(h->is_border()){
+				on_border = true;
+				const typename Tri::Point& y = h->prev()->opposite()->vertex()->point();
+				const typename Tri::Point& s = h->opposite()->vertex()->point();
+				const typename Tri::Point& t = h->next()->vertex()->point();
+				const typename Tri::Point& z = h->next()->next()->vertex()->point();
+				if( (kernel.orientation(y,s,p) == Orientation::left_turn) || (kernel.orientation(s,p,t) == Orientation::left_turn) ||
+				  (kernel.orientation(p,t,z) == Orientation::left_turn) ){ in_place = false; }
+			}
+			else if(kernel.orientation(p, h->next()->vertex()->point(), h->opposite()->vertex()->point()) != Orientation::left_turn){
+				in_place = false;
+			}
+			h = h->next()->opposite();
+		} while(h != vh->halfedge());
+
+		if(in_place){
+			tri.set_point(vh, p);
+			Lop_statistics local{0,0,0};
+			std::vector<Halfedge_handle> suspect_list;
+			push_star<Tri>(vh->halfedge(), suspect_list, local);
+			restore_pd_delaunay(tri, kernel, u, v, suspect_list, local);
+			if(stat){
+				stat->flip_count += local.flip_count;
+				stat->suspect_push_count += local.suspect_push_count;
+				stat->test_count += local.test_count;
+			}
+			return vh;
+		}
+		if(on_border){ return typename Tri::Vertex_handle(); }
+		Location<Tri> loc = locate(tri, kernel, p, incident_face<Tri>(vh));
+		if( (loc.type == Location_type::outside) || (loc.type == Location_type::vertex) ){ return typename Tri::Vertex_handle(); }
+		typename Tri::Vertex_handle neighbor = vh->halfedge()->opposite()->vertex();
+		if(!remove_vertex(tri, kernel, u, v, vh, stat)){ return typename Tri::Vertex_handle(); }
+		return insert_vertex(tri, kernel, u, v, p, incident_face<Tri>(neighbor), stat);
+	}
+
+}
+#endif
@@ -0,0 +1,162 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include<string>
+#include<sstream>
+#ifdef __linux__
+#include<linux/perf_event.h>
+#include<sys/ioctl.h>
+#include<sys/syscall.h>
+#include<unistd.h>
+#endif
+
+// Hardware performance counters of the calling thread, read with the
+// Linux perf_event_open system call.
+// Each event is opened on its own, so that the events the machine (or
+// the container) does provide are still counted when others are not.
+// Where perf_event_open is unavailable (e.g., not permitted by
+// perf_event_paranoid or by a seccomp profile, or not Linux), no event is
+// available and the counters report as such instead of failing.
+namespace trilib::perf {
+
+	// The events counted.
+	enum class Event { cycles, instructions, branch_misses, l1d_misses, llc_misses };
+
+	// The number of events.
+	constexpr std::size_t event_count = 5;
+
+	inline const char* event_name(Event event){
+		static const char* const names[event_count] = {"cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses"};
+		return names[static_cast<std::size_t>(event)];
+	}
+
+	// The counts of the events over an interval. The counts of an event
+	// that was multiplexed with others are scaled up to the whole interval.
+	struct Sample {
+		double values[event_count];
+		bool valid[event_count];
+	};
+
+	class Counters {
+		public:
+			// Opens the counters (if possible), initially stopped.
+			Counters() {
+				for(std::size_t i = 0; i < event_count; ++i){ fds_[i] = open_event(static_cast<Event>(i)); }
+			}
+			~Counters() {
+#ifdef __linux__
+				for(int fd : fds_){
+					if(fd >= 0){ ::close(fd); }
+				}
+#endif
+			}
+			Counters(const Counters&) = delete;
+			Counters& operator=(const Counters&) = delete;
+
+			// Tests if any event can be counted.
+			bool available() const {
+				for(int fd : fds_){
+					if(fd >= 0){ return true; }
+				}
+				return false;
+			}
+
+			// Resets and starts the counters.
+			void start() {
+#ifdef __linux__
+				for(int fd : fds_){
+					if(fd >= 0){
+						::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+						::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+					}
+				}
+#endif
+			}
+
+			// Stops the counters and returns their counts since start.
+			Sample stop() {
+				Sample sample{};
+#ifdef __linux__
+				for(int fd : fds_){
+					if(fd >= 0){ ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0); }
+				}
+				for(std::size_t i = 0; i < event_count; ++i){
+					// The value, the time enabled and the time running.
+					std::uint64_t data[3];
+					if( (fds_[i] >= 0) && (::read(fds_[i], data, sizeof(data)) == sizeof(data)) && (data[2] > 0) ){
+						sample.values[i] = double(data[0]) * double(data[1]) / double(data[2]);
+						sample.valid[i] = true;
+					}
+				}
+#endif
+				return sample;
+			}
+
+		private:
+			static int open_event(Event event) {
+#ifdef __linux__
+				perf_event_attr attr;
+				std::memset(&attr, 0, sizeof(attr));
+				attr.size = sizeof(attr);
+				attr.disabled = 1;
+				attr.exclude_kernel = 1;
+				attr.exclude_hv = 1;
+				attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+				switch(event){
+					case Event::cycles:
+						attr.type = PERF_TYPE_HARDWARE;
+						attr.config = PERF_COUNT_HW_CPU_CYCLES;
+						break;
+					case Event::instructions:
+						attr.type = PERF_TYPE_HARDWARE;
+						attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+						break;
+					case Event::branch_misses:
+						attr.type = PERF_TYPE_HARDWARE;
+						attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+						break;
+					case Event::l1d_misses:
+						attr.type = PERF_TYPE_HW_CACHE;
+						attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+						  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+						break;
+					case Event::llc_misses:
+						attr.type = PERF_TYPE_HARDWARE;
+						attr.config = PERF_COUNT_HW_CACHE_MISSES;
+						break;
+				}
+				return int(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+				static_cast<void>(event);
+				return -1;
+#endif
+			}
+
+			int fds_[event_count];
+	};
+
+	// Formats the counts of a sample per operation (e.g., per tested edge),
+	// as " name=count" fields to follow the timings of a benchmark. The
+	// events that were not counted are omitted.
+	inline std::string format_per_operation(const Sample& sample, double operations){
+		std::ostringstream out;
+		bool any = false;
+		if(operations < 1.0){ operations = 1.0; }
+		for(std::size_t i = 0; i < event_count; ++i){
+			if(!sample.valid[i]){ continue; }
+			out<<" "<<event_name(static_cast<Event>(i))<<"/op="<<(sample.values[i] / operations);
+			any = true;
+		}
+		std::size_t cycles = static_cast<std::size_t>(Event::cycles);
+		std::size_t instructions = static_cast<std::size_t>(Event::instructions);
+		if(sample.valid[cycles] && sample.valid[instructions] && (sample.values[cycles] > 0)){
+			out<<" ipc="<<(sample.values[instructions] / sample.values[cycles]);
+		}
+		if(!any){ out<<" counters=n/a"; }
+		return out.str();
+	}
+
+}
+#endif
@@ -0,0 +1,184 @@
+#ifndef RUN_REPORT_HPP
+#define RUN_REPORT_HPP
+#include<cmath>
+#include<cstddef>
+#include<limits>
+#include<ostream>
+#include<sstream>
+#include<string>
+#include<utility>
+#include<vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include<sys/resource.h>
+#endif
+#include"ra/kernel.hpp"
+#include"ra/interval.hpp"
+
+// A report of a run (e.g., of delaunay_triangulation on one mesh) for
+// collecting performance telemetry: named sections of named values,
+// written as a JSON object of objects.
+namespace trilib::report {
+
+	// Returns the peak resident set size of the process in bytes, or zero
+	// if it is unknown.
+	inline std::size_t peak_rss_bytes(){
+#if defined(__unix__) || defined(__APPLE__)
+		rusage usage;
+		if(::getrusage(RUSAGE_SELF, &usage) != 0){ return 0; }
+#ifdef __APPLE__
+		return std::size_t(usage.ru_maxrss);
+#else
+		// Linux reports the size in kilobytes.
+		return std::size_t(usage.ru_maxrss) * 1024;
+#endif
+#else
+		return 0;
+#endif
+	}
+
+	class Report {
+		public:
+			// Sets a value of a section (adding the section and the value
+			// after the existing ones if they are new).
+			void set(const std::string& section, const std::string& name, std::size_t value){
+				set_text(section, name, std::to_string(value));
+			}
+			void set(const std::string& section, const std::string& name, double value){
+				if(!std::isfinite(value)){
+					set_text(section, name, "null");
+					return;
+				}
+				std::ostringstream out;
+				out.precision(std::numeric_limits<double>::max_digits10);
+				out<<value;
+				set_text(section, name, out.str());
+			}
+			void set(const std::string& section, const std::string& name, bool value){
+				set_text(section, name, value ? "true" : "false");
+			}
+			void set(const std::string& section, const std::string& name, const std::string& value){
+				set_text(section, name, quote(value));
+			}
+			void set(const std::string& section, const std::string& name, const char* value){
+				set(section, name, std::string(value));
+			}
+
+			// Writes the report as a JSON object (on one line).
+			void write_json(std::ostream& out) const {
+				out<<"{";
+				for(std::size_t i = 0; i < sections_.size(); ++i){
+					out<<(i ? "," : "")<<quote(sections_[i].name)<<":{";
+					const auto& values = sections_[i].values;
+					for(std::size_t j = 0; j < values.size(); ++j){
+						out<<(j ? "," : "")<<quote(values[j].first)<<":"<<values[j].second;
+					}
+					out<<"}";
+				}
+				out<<"}\n";
+			}
+
+		private:
+			struct Section {
+				std::string name;
+				// The names and the JSON texts of the values.
+				std::vector<std::pair<std::string,std::string>> values;
+			};
+
+			void set_text(const std::string& section, const std::string& name, const std::string& text){
+				Section* s = nullptr;
+				for(Section& t : sections_){
+					if(t.name == section){ s = &t; }
+				}
+				if(!s){
+					sections_.push_back(Section{section, {}});
+					s = &sections_.back();
+				}
+				for(auto& value : s->values){
+					if(value.first == name){
+						value.second = text;
+						return;
+					}
+				}
+				s->values.push_back(std::make_pair(name, text));
+			}
+
+			static std::string quote(const std::string& text){
+				std::string result("\"");
+				for(char c : text){
+					if( (c == '"') || (c == '\\') ){
+						result += '\\';
+						result += c;
+					}
+					else if(static_cast<unsigned char>(c) < 0x20){
+						const char* digits = "0123456789abcdef";
+						result += "\\u00";
+						result += digits[(c >> 4) & 0xf];
+						result += digits[c & 0xf];
+					}
+					else{ result += c; }
+				}
+				return result + "\"";
+			}
+
+			std::vector<Section> sections_;
+	};
+
+	// Adds every counter of the kernel statistics to the section "kernel",
+	// and the fraction of each test that needed exact arithmetic to the
+	// section "exact_ratio".
+	template<class R>
+	void add_kernel_statistics(Report& report, const typename ra::geometry::Kernel<R>::Statistics& st){
+		const std::pair<const char*, std::size_t> counts[] = {
+			{"orientation_total_count", st.orientation_total_count},
+			{"orientation_exact_count", st.orientation_exact_count},
+			{"orientation_exact_allocation_count", st.orientation_exact_allocation_count},
+			{"orientation_integer_count", st.orientation_integer_count},
+			{"orientation_filter_skip_count", st.orientation_filter_skip_count},
+			{"orientation_filter_switch_count", st.orientation_filter_switch_count},
+			{"preferred_direction_total_count", st.preferred_direction_total_count},
+			{"preferred_direction_exact_count", st.preferred_direction_exact_count},
+			{"preferred_direction_exact_allocation_count", st.preferred_direction_exact_allocation_count},
+			{"preferred_direction_integer_count", st.preferred_direction_integer_count},
+			{"preferred_direction_filter_skip_count", st.preferred_direction_filter_skip_count},
+			{"preferred_direction_filter_switch_count", st.preferred_direction_filter_switch_count},
+			{"side_of_oriented_circle_total_count", st.side_of_oriented_circle_total_count},
+			{"side_of_oriented_circle_exact_count", st.side_of_oriented_circle_exact_count},
+			{"side_of_oriented_circle_exact_allocation_count", st.side_of_oriented_circle_exact_allocation_count},
+			{"side_of_oriented_circle_integer_count", st.side_of_oriented_circle_integer_count},
+			{"side_of_oriented_circle_filter_skip_count", st.side_of_oriented_circle_filter_skip_count},
+			{"side_of_oriented_circle_filter_switch_count", st.side_of_oriented_circle_filter_switch_count},
+			{"side_of_oriented_circle_semi_static_count", st.side_of_oriented_circle_semi_static_count},
+			{"locally_pd_delaunay_edge_total_count", st.locally_pd_delaunay_edge_total_count},
+			{"locally_pd_delaunay_edge_exact_count", st.locally_pd_delaunay_edge_exact_count},
+			{"locally_pd_delaunay_edge_exact_allocation_count", st.locally_pd_delaunay_edge_exact_allocation_count},
+			{"locally_pd_delaunay_edge_integer_count", st.locally_pd_delaunay_edge_integer_count},
+			{"locally_pd_delaunay_edge_filter_skip_count", st.locally_pd_delaunay_edge_filter_skip_count},
+			{"locally_pd_delaunay_edge_filter_switch_count", st.locally_pd_delaunay_edge_filter_switch_count},
+			{"locally_pd_delaunay_edge_tie_count", st.locally_pd_delaunay_edge_tie_count},
+			{"flippable_quad_total_count", st.flippable_quad_total_count},
+			{"flippable_quad_exact_count", st.flippable_quad_exact_count},
+			{"flippable_quad_exact_allocation_count", st.flippable_quad_exact_allocation_count},
+			{"flippable_quad_integer_count", st.flippable_quad_integer_count},
+			{"flippable_quad_filter_skip_count", st.flippable_quad_filter_skip_count},
+			{"flippable_quad_filter_switch_count", st.flippable_quad_filter_switch_count},
+			{"flippable_quad_semi_static_count", st.flippable_quad_semi_static_count},
+		};
+		for(const auto& count : counts){ report.set("kernel", count.first, count.second); }
+		auto ratio = [](std::size_t exact, std::size_t total){ return (total > 0) ? double(exact) / double(total) : 0.0; };
+		report.set("exact_ratio", "orientation", ratio(st.orientation_exact_count, st.orientation_total_count));
+		report.set("exact_ratio", "preferred_direction", ratio(st.preferred_direction_exact_count, st.preferred_direction_total_count));
+		report.set("exact_ratio", "side_of_oriented_circle", ratio(st.side_of_oriented_circle_exact_count, st.side_of_oriented_circle_total_count));
+		report.set("exact_ratio", "locally_pd_delaunay_edge",
+		  ratio(st.locally_pd_delaunay_edge_exact_count, st.locally_pd_delaunay_edge_total_count));
+		report.set("exact_ratio", "flippable_quad", ratio(st.flippable_quad_exact_count, st.flippable_quad_total_count));
+	}
+
+	// Adds the interval arithmetic statistics to the section "interval".
+	template<class T>
+	void add_interval_statistics(Report& report, const typename ra::math::interval<T>::statistics& st){
+		report.set("interval", "arithmetic_op_count", std::size_t(st.arithmetic_op_count));
+		report.set("interval", "indeterminate_result_count", std::size_t(st.indeterminate_result_count));
+	}
+
+}
+#endif
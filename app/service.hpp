@@ -0,0 +1,153 @@
+#ifndef SERVICE_HPP
+#define SERVICE_HPP
+#include<cerrno>
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include<string>
+#include<streambuf>
+#include<sys/socket.h>
+#include<sys/un.h>
+#include<unistd.h>
+
+// The protocol of the service mode of delaunay_triangulation.
+// A client sends a sequence of requests over a Unix domain socket (or the
+// standard input of the server) and receives one response per request, in
+// order. Each message is a fixed-size header followed by a payload of the
+// given size holding a mesh in OFF format or in the binary format of
+// Triangulation_2. All integers are in native byte order, since client and
+// server run on the same host.
+namespace trilib::service {
+
+	// The format of the mesh in a payload.
+	enum class Format : std::uint32_t { off = 0, binary = 1 };
+
+	// The status of a response.
+	enum class Status : std::uint32_t { ok = 0, invalid_mesh = 1, invalid_request = 2 };
+
+	struct Request_header {
+		// The signature "PDTQ".
+		char magic[4];
+		// The format of the input mesh (and of the result).
+		Format format;
+		// The size of the payload in bytes.
+		std::uint64_t size;
+	};
+
+	struct Response_header {
+		// The signature "PDTR".
+		char magic[4];
+		Status status;
+		// The number of edge flips performed.
+		std::uint64_t flip_count;
+		// The time spent by the server on the request, in seconds.
+		double seconds;
+		// The size of the payload in bytes.
+		std::uint64_t size;
+	};
+
+	// The largest payload accepted by the server.
+	constexpr std::uint64_t max_payload_size = std::uint64_t(1) << 32;
+
+	// Reads exactly n bytes. Returns false on error or end of file.
+	inline bool read_all(int fd, void* buffer, std::size_t n){
+		char* p = static_cast<char*>(buffer);
+		while(n > 0){
+			ssize_t count = ::read(fd, p, n);
+			if(count < 0 && errno == EINTR){ continue; }
+			if(count <= 0){ return false; }
+			p += count;
+			n -= count;
+		}
+		return true;
+	}
+
+	// Writes exactly n bytes. Returns false on error.
+	inline bool write_all(int fd, const void* buffer, std::size_t n){
+		const char* p = static_cast<const char*>(buffer);
+		while(n > 0){
+			ssize_t count = ::write(fd, p, n);
+			if(count < 0 && errno == EINTR){ continue; }
+			if(count <= 0){ return false; }
+			p += count;
+			n -= count;
+		}
+		return true;
+	}
+
+	inline bool make_address(const std::string& path, sockaddr_un& address){
+		std::memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if(path.size() >= sizeof(address.sun_path)){ return false; }
+		std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+		return true;
+	}
+
+	// Creates a socket listening at path, replacing any stale socket file.
+	// Returns -1 on error.
+	inline int listen_unix(const std::string& path){
+		sockaddr_un address;
+		if(!make_address(path, address)){ return -1; }
+		int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if(fd < 0){ return -1; }
+		::unlink(path.c_str());
+		if( (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) || (::listen(fd, 16) < 0) ){
+			::close(fd);
+			return -1;
+		}
+		return fd;
+	}
+
+	// Connects to the socket at path. Returns -1 on error.
+	inline int connect_unix(const std::string& path){
+		sockaddr_un address;
+		if(!make_address(path, address)){ return -1; }
+		int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if(fd < 0){ return -1; }
+		if(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0){
+			::close(fd);
+			return -1;
+		}
+		return fd;
+	}
+
+	// Sends a request and waits for its response. The result is stored
+	// in result, reusing its storage. Returns false on a transport error.
+	inline bool call(int fd, Format format, const std::string& payload, Response_header& header, std::string& result){
+		Request_header request{{'P','D','T','Q'}, format, payload.size()};
+		if( !write_all(fd, &request, sizeof(request)) || !write_all(fd, payload.data(), payload.size()) ){ return false; }
+		if( !read_all(fd, &header, sizeof(header)) || (std::memcmp(header.magic, "PDTR", 4) != 0) ){ return false; }
+		result.resize(header.size);
+		return read_all(fd, &result[0], result.size());
+	}
+
+	// A read-only stream buffer over a block of memory, so that a payload
+	// can be parsed without copying it.
+	class memory_buffer : public std::streambuf {
+		public:
+			memory_buffer(const char* data, std::size_t size) {
+				char* p = const_cast<char*>(data);
+				setg(p, p, p + size);
+			}
+	};
+
+	// A stream buffer appending to a string, so that the storage of the
+	// string is reused from one response to the next.
+	class string_buffer : public std::streambuf {
+		public:
+			explicit string_buffer(std::string& s) : s_(s) {}
+		protected:
+			int_type overflow(int_type c) override {
+				if(c != traits_type::eof()){ s_.push_back(traits_type::to_char_type(c)); }
+				return traits_type::not_eof(c);
+			}
+			std::streamsize xsputn(const char* p, std::streamsize n) override {
+				s_.append(p, n);
+				return n;
+			}
+		private:
+			std::string& s_;
+	};
+
+}
+#endif
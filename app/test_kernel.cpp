@@ -1,6 +1,125 @@
 #include <CGAL/Cartesian.h>
 #include"ra/kernel.hpp"
 #include<iostream>
+#include<random>
+
+// Tests that the preferred-directions tests with the directions (UX,UY)
+// and (VX,VY) given as compile-time constants agree with those with the
+// same directions given as vectors, on rectangles (whose vertices are
+// cocircular, so the tie-break is needed) and on random quadrilaterals,
+// with integer coordinates multiplied by scale.
+template<int UX, int UY, int VX, int VY>
+bool fixed_directions_agree(double scale){
+	using point = typename CGAL::Cartesian<double>::Point_2;
+	using vector = typename CGAL::Cartesian<double>::Vector_2;
+	ra::geometry::Kernel<double> obj;
+	ra::geometry::Pd_directions<UX,UY,VX,VY> directions;
+	vector u(UX,UY); vector v(VX,VY);
+	std::mt19937 gen(1);
+	std::uniform_int_distribution<int> coord(-20,20);
+	for(int i = 0; i < 2000; ++i){
+		int x0 = coord(gen); int x1 = x0 + 1 + (coord(gen) + 20) / 4;
+		int y0 = coord(gen); int y1 = y0 + 1 + (coord(gen) + 20) / 4;
+		point a(x0*scale,y0*scale); point b(x1*scale,y0*scale); point c(x1*scale,y1*scale); point d(x0*scale,y1*scale);
+		point e(coord(gen)*scale,coord(gen)*scale);
+		if( (obj.is_locally_pd_delaunay_edge(a,b,c,d,u,v) != obj.is_locally_pd_delaunay_edge(a,b,c,d,directions)) ||
+		  (obj.needs_pd_flip(a,b,c,d,u,v) != obj.needs_pd_flip(a,b,c,d,directions)) ||
+		  (obj.needs_pd_flip(a,b,c,e,u,v) != obj.needs_pd_flip(a,b,c,e,directions)) ||
+		  (obj.preferred_direction(a,c,b,e,v) != obj.preferred_direction(a,c,b,e,directions.v)) ){
+			return false;
+		}
+	}
+	return true;
+}
+
+// Tests if the tests on cached points agree with those on the points, on
+// nearly cocircular quadrilaterals (the cells of a grid multiplied by
+// scale) and on random quadrilaterals.
+bool cached_points_agree(double scale){
+	using point = typename CGAL::Cartesian<double>::Point_2;
+	using vector = typename CGAL::Cartesian<double>::Vector_2;
+	using knl = ra::geometry::Kernel<double>;
+	knl obj;
+	vector u(1,0); vector v(1,1);
+	std::mt19937 gen(2);
+	std::uniform_int_distribution<int> coord(-20,20);
+	std::uniform_real_distribution<double> real(-1.0,1.0);
+	for(int i = 0; i < 2000; ++i){
+		int x0 = coord(gen); int x1 = x0 + 1 + (coord(gen) + 20) / 4;
+		int y0 = coord(gen); int y1 = y0 + 1 + (coord(gen) + 20) / 4;
+		point p[5] = {point(x0*scale,y0*scale), point(x1*scale,y0*scale), point(x1*scale,y1*scale), point(x0*scale,y1*scale),
+		  point(real(gen)*20*scale,real(gen)*20*scale)};
+		knl::Cached_point q[5];
+		for(int j = 0; j < 5; ++j){ q[j] = knl::make_cached_point(p[j]); }
+		if( (obj.side_of_oriented_circle(p[0],p[1],p[2],p[3]) != obj.side_of_oriented_circle(q[0],q[1],q[2],q[3])) ||
+		  (obj.side_of_oriented_circle(p[0],p[1],p[2],p[4]) != obj.side_of_oriented_circle(q[0],q[1],q[2],q[4])) ||
+		  (obj.needs_pd_flip(p[0],p[1],p[2],p[3],u,v) != obj.needs_pd_flip(q[0],q[1],q[2],q[3],u,v)) ||
+		  (obj.needs_pd_flip(p[0],p[1],p[2],p[4],u,v) != obj.needs_pd_flip(q[0],q[1],q[2],q[4],u,v)) ||
+		  (obj.needs_pd_flip(p[4],p[1],p[2],p[3],u,v) != obj.needs_pd_flip(q[4],q[1],q[2],q[3],u,v)) ){
+			return false;
+		}
+	}
+	return true;
+}
+
+// Tests if the signs of a*b - c*d + e computed with expansions agree with
+// those computed with exct, on random values for which the products
+// nearly cancel and e is much smaller than them.
+bool expansion_signs_agree(){
+	using xpn = ra::math::expansion;
+	using exct = typename ra::geometry::Kernel<double>::exct;
+	std::mt19937_64 gen(3);
+	std::uniform_real_distribution<double> real(-1.0,1.0);
+	std::uniform_int_distribution<int> exponent(-60,60);
+	std::uniform_int_distribution<int> ulps(-2,2);
+	std::uniform_int_distribution<int> gap(40,100);
+	for(int i = 0; i < 10000; ++i){
+		ra::math::expansion_scope scope;
+		double a = std::ldexp(real(gen),exponent(gen));
+		double b = std::ldexp(real(gen),exponent(gen));
+		if( (a == 0.0) || (b == 0.0) ){ continue; }
+		double c = a + ulps(gen) * std::ldexp(std::abs(a),-52);
+		double d = b;
+		double e = std::ldexp(real(gen),std::ilogb(a*b) - gap(gen));
+		exct exact = (exct(a)*exct(b)) - (exct(c)*exct(d)) + exct(e);
+		int expected = (exact > exct(0)) - (exact < exct(0));
+		if( (((xpn(a)*xpn(b)) - (xpn(c)*xpn(d))) + xpn(e)).sign() != expected ){
+			return false;
+		}
+	}
+	return true;
+}
+
+// Tests that the exact incircle test and tie-break, on random points and
+// directions whose coordinates have exponents spread over the whole of
+// expansion_exponent_bound, use no more of the arena than the capacity
+// computed for them.
+bool expansion_capacity_holds(){
+	using knl = ra::geometry::Kernel<double>;
+	using xpn = ra::math::expansion;
+	using point = typename knl::Point;
+	using vector = typename knl::Vector;
+	std::mt19937_64 gen(5);
+	std::uniform_real_distribution<double> mantissa(0.5,1.0);
+	std::uniform_int_distribution<int> exponent(-knl::expansion_exponent_bound,knl::expansion_exponent_bound);
+	auto coordinate = [&](){ return std::ldexp((gen() & 1) ? mantissa(gen) : -mantissa(gen), exponent(gen)); };
+	for(int i = 0; i < 1000; ++i){
+		point a(coordinate(),coordinate()); point b(coordinate(),coordinate());
+		point c(coordinate(),coordinate()); point d(coordinate(),coordinate());
+		vector u(coordinate(),coordinate()); vector v(coordinate(),coordinate());
+		std::size_t capacity = knl::locally_pd_delaunay_edge_capacity(u,v);
+		ra::math::expansion_scope scope(capacity);
+		ra::math::expansion_arena::mark_type start = ra::math::expansion_arena::local().mark();
+		knl::Quad_differences<xpn> q = knl::make_quad_differences<xpn>(a,b,c,d);
+		knl::side_of_oriented_circle_sign(q);
+		knl::pd_tie_break(q,u,v);
+		ra::math::expansion_arena::mark_type end = ra::math::expansion_arena::local().mark();
+		if( (end.block != start.block) || ((end.offset - start.offset) > capacity) ){
+			return false;
+		}
+	}
+	return true;
+}
 
 int main(){
 	using std::cout;
@@ -34,6 +153,10 @@ int main(){
 	point anc(0,0); point bnc(1,0); point cnc(2,0); point dnc(2,1);
 	cout<<"Test for convexity(true): "<<(obj_A.is_strictly_convex_quad(asc,bsc,csc,dsc))<<endl;
 	cout<<"Test for convexity(false): "<<(obj_A.is_strictly_convex_quad(anc,bnc,cnc,dnc))<<endl;
+	// Test is_flippable_quad
+	point afq(0,0); point bfq(2,0); point cfq(2,2); point dfq(1,3); point efq(3,2.5);
+	cout<<"Test for flippable(true): "<<(obj_A.is_flippable_quad(asc,bsc,csc,dsc))<<endl;
+	cout<<"Test for flippable(false): "<<(obj_A.is_flippable_quad(cfq,dfq,afq,efq))<<endl;
 	//Test is_locally_delaunay_edge
 	point ad(0,0); point bd(1,0); point cd(1,1); point dd(0,1);
 	point adn(0,0); point bdn(5,0); point cdn(5,5); point ddn(2,3);
@@ -42,13 +165,90 @@ int main(){
 	// Test is_locally_pd_delaunay_edge
 	cout<<"Test edge for pref dir loc delaunay(true): "<<(obj_A.is_locally_pd_delaunay_edge(ad,bd,cd,dd,up,vp))<<endl;
 	cout<<"Test edge for pref dir loc delaunay(false): "<<(obj_A.is_locally_pd_delaunay_edge(ad,bd,cd,dd,wp,vp))<<endl;
+	// Test needs_pd_flip
+	cout<<"Test edge needs pd flip(false): "<<(obj_A.needs_pd_flip(ad,bd,cd,dd,up,vp))<<endl;
+	cout<<"Test edge needs pd flip(true): "<<(obj_A.needs_pd_flip(ad,bd,cd,dd,wp,vp))<<endl;
+	cout<<"Test edge needs pd flip(true): "<<(obj_A.needs_pd_flip(adn,bdn,cdn,ddn,up,vp))<<endl;
+	// Test that integer and non-integer coordinates give the same results
+	point ai(0.5,0.5); point bi(2.5,0.5); point ci(0.5,2.5); point di(2.5,2.5); point ei(1.5,1.5);
+	point ab(1<<29,0); point bb((1<<29)+2,0); point cb(1<<29,2); point db((1<<29)+2,2);
+	cout<<"Test for on_boundary with non-integers(true): "<<((obj_A.side_of_oriented_circle(ai,bi,ci,di)) == (ort_side::on_boundary))<<endl;
+	cout<<"Test for on_positive_side with non-integers(true): "<<((obj_A.side_of_oriented_circle(ai,bi,ci,ei)) == (ort_side::on_positive_side))<<endl;
+	cout<<"Test for on_boundary with large integers(true): "<<((obj_A.side_of_oriented_circle(ab,bb,cb,db)) == (ort_side::on_boundary))<<endl;
+	cout<<"Test for collinear with non-integers(true): "<<((obj_A.orientation(ai,ei,di)) == (ort::collinear))<<endl;
+	cout<<"Test for equally close with non-integers(true): "<<((obj_A.preferred_direction(ai,di,bi,ci,vp)) == 0)<<endl;
+	cout<<"Test edge for pref dir loc delaunay with non-integers(true): "<<(obj_A.is_locally_pd_delaunay_edge(ai,bi,di,ci,up,vp))<<endl;
+	cout<<"Test edge for pref dir loc delaunay with non-integers(false): "<<(obj_A.is_locally_pd_delaunay_edge(ai,bi,di,ci,wp,vp))<<endl;
+	// Test that the kernel's value points and CGAL::Cartesian points give the same results
+	using vpoint = typename ra::geometry::Kernel<double>::Point;
+	using vvector = typename ra::geometry::Kernel<double>::Vector;
+	vpoint av(0.5,0.5); vpoint bv(2.5,0.5); vpoint cv(0.5,2.5); vpoint dv(2.5,2.5); vpoint ev(1.5,1.5);
+	cout<<"Test for on_positive_side with value points(true): "<<((obj_A.side_of_oriented_circle(av,bv,cv,ev)) == (obj_A.side_of_oriented_circle(ai,bi,ci,ei)))<<endl;
+	cout<<"Test for collinear with value points(true): "<<((obj_A.orientation(av,ev,dv)) == (ort::collinear))<<endl;
+	cout<<"Test edge for pref dir loc delaunay with value points(true): "<<((obj_A.is_locally_pd_delaunay_edge(av,bv,dv,cv,vvector(2,1),vvector(1,0))) == (obj_A.is_locally_pd_delaunay_edge(ai,bi,di,ci,up,vp)))<<endl;
+	cout<<"Test edge needs pd flip with value points(true): "<<((obj_A.needs_pd_flip(av,bv,dv,cv,vvector(-1,2),vvector(1,0))) == (obj_A.needs_pd_flip(ai,bi,di,ci,wp,vp)))<<endl;
 	// Test get_statistics and clear_statistics
 	stat st;
 	obj_A.get_statistics(st);
-	cout<<"Current statistics: ort tot="<<(st.orientation_total_count)<<" ort ex="<<(st.orientation_exact_count)<<" pd tot="<<(st.preferred_direction_total_count)<<" pd ex="<<(st.preferred_direction_exact_count)<<" crc tot="<<(st.side_of_oriented_circle_total_count)<<" crc ex="<<(st.side_of_oriented_circle_exact_count)<<endl;
+	cout<<"Current statistics: ort tot="<<(st.orientation_total_count)<<" ort ex="<<(st.orientation_exact_count)<<" pd tot="<<(st.preferred_direction_total_count)<<" pd ex="<<(st.preferred_direction_exact_count)<<" crc tot="<<(st.side_of_oriented_circle_total_count)<<" crc ex="<<(st.side_of_oriented_circle_exact_count)<<" ort int="<<(st.orientation_integer_count)<<" pd int="<<(st.preferred_direction_integer_count)<<" crc int="<<(st.side_of_oriented_circle_integer_count)<<" pde tot="<<(st.locally_pd_delaunay_edge_total_count)<<" pde ex="<<(st.locally_pd_delaunay_edge_exact_count)<<" pde int="<<(st.locally_pd_delaunay_edge_integer_count)<<" pde tie="<<(st.locally_pd_delaunay_edge_tie_count)<<" fq tot="<<(st.flippable_quad_total_count)<<" fq ex="<<(st.flippable_quad_exact_count)<<" fq int="<<(st.flippable_quad_integer_count)<<" ort skip="<<(st.orientation_filter_skip_count)<<" ort switch="<<(st.orientation_filter_switch_count)<<" crc skip="<<(st.side_of_oriented_circle_filter_skip_count)<<" crc switch="<<(st.side_of_oriented_circle_filter_switch_count)<<" fq skip="<<(st.flippable_quad_filter_skip_count)<<" fq switch="<<(st.flippable_quad_filter_switch_count)<<endl;
+	obj_A.clear_statistics();
+	obj_A.get_statistics(st);
+	cout<<"Cleared statistics: ort tot="<<(st.orientation_total_count)<<" ort ex="<<(st.orientation_exact_count)<<" pd tot="<<(st.preferred_direction_total_count)<<" pd ex="<<(st.preferred_direction_exact_count)<<" crc tot="<<(st.side_of_oriented_circle_total_count)<<" crc ex="<<(st.side_of_oriented_circle_exact_count)<<" ort int="<<(st.orientation_integer_count)<<" pd int="<<(st.preferred_direction_integer_count)<<" crc int="<<(st.side_of_oriented_circle_integer_count)<<" pde tot="<<(st.locally_pd_delaunay_edge_total_count)<<" pde ex="<<(st.locally_pd_delaunay_edge_exact_count)<<" pde int="<<(st.locally_pd_delaunay_edge_integer_count)<<" pde tie="<<(st.locally_pd_delaunay_edge_tie_count)<<" fq tot="<<(st.flippable_quad_total_count)<<" fq ex="<<(st.flippable_quad_exact_count)<<" fq int="<<(st.flippable_quad_integer_count)<<" ort skip="<<(st.orientation_filter_skip_count)<<" ort switch="<<(st.orientation_filter_switch_count)<<" crc skip="<<(st.side_of_oriented_circle_filter_skip_count)<<" crc switch="<<(st.side_of_oriented_circle_filter_switch_count)<<" fq skip="<<(st.flippable_quad_filter_skip_count)<<" fq switch="<<(st.flippable_quad_filter_switch_count)<<endl;
+	// Test adaptive selection of the interval filter
+	point af(0.1,0.1); point bf(0.2,0.2); point cf(0.3,0.3); point df(0.3,0.1);
+	obj_A.clear_statistics();
+	bool all_collinear = true;
+	for(int i = 0; i < 1000; ++i){ all_collinear = all_collinear && ((obj_A.orientation(af,bf,cf)) == (ort::collinear)); }
+	obj_A.get_statistics(st);
+	cout<<"Test degenerate orientations with filter switched off(true): "<<(all_collinear && (st.orientation_filter_switch_count == 1) && (st.orientation_filter_skip_count > 0) && (st.orientation_exact_count == 1000))<<endl;
+	bool all_right = true;
+	for(int i = 0; i < 10000; ++i){ all_right = all_right && ((obj_A.orientation(af,bf,df)) == (ort::right_turn)); }
+	obj_A.get_statistics(st);
+	cout<<"Test filter switched back on(true): "<<(all_right && (st.orientation_filter_switch_count == 2) && (st.orientation_exact_count < 10000))<<endl;
+	cout<<"Filter statistics: ort skip="<<(st.orientation_filter_skip_count)<<" ort switch="<<(st.orientation_filter_switch_count)<<" ort ex="<<(st.orientation_exact_count)<<endl;
+	// Test the directions as compile-time constants against the same directions as vectors
+	for(double scale : {1.0, 0.125, 0.1}){
+		bool agree = fixed_directions_agree<1,0,1,1>(scale) && fixed_directions_agree<0,1,-1,1>(scale) &&
+		  fixed_directions_agree<-1,-1,1,0>(scale) && fixed_directions_agree<2,-3,1,2>(scale) && fixed_directions_agree<3,3,0,-2>(scale);
+		cout<<"Test fixed directions agree with vectors at scale "<<scale<<"(true): "<<agree<<endl;
+	}
+	// Test the tests on cached points against those on the points
+	for(double scale : {1.0, 0.1, 1e-20, 1e20}){
+		cout<<"Test cached points agree at scale "<<scale<<"(true): "<<cached_points_agree(scale)<<endl;
+	}
+	obj_A.clear_statistics();
+	point as(0.1,0.1); point bs(0.7,0.2); point cs(0.3,0.9); point ds(0.4,0.4);
+	obj_A.side_of_oriented_circle(knlD::make_cached_point(as),knlD::make_cached_point(bs),knlD::make_cached_point(cs),knlD::make_cached_point(ds));
+	obj_A.get_statistics(st);
+	cout<<"Test semi-static filter decides a cached test(true): "<<((st.side_of_oriented_circle_semi_static_count == 1) && (st.side_of_oriented_circle_total_count == 1))<<endl;
+	// Test expansion arithmetic
+	{
+		using xpn = ra::math::expansion;
+		ra::math::expansion_scope scope;
+		xpn big(1e16); xpn one(1.0);
+		xpn sum = (big + one) - big;
+		cout<<"Test expansion sum is exact(true): "<<((sum.size() == 1) && (sum.estimate() == 1.0))<<endl;
+		xpn zero = ((xpn(0.1) + xpn(0.2)) - xpn(0.1)) - xpn(0.2);
+		cout<<"Test expansion sum eliminates zero components(true): "<<((zero.size() == 1) && (zero.sign() == 0))<<endl;
+		// (2^27+1)^2 = 2^54 + 2^28 + 1, which needs two components.
+		xpn square = xpn(134217729.0) * xpn(134217729.0);
+		cout<<"Test expansion product is exact(true): "<<((square.size() == 2) && ((square - xpn(std::ldexp(1.0,54)) - xpn(268435457.0)).sign() == 0))<<endl;
+		xpn wide = (xpn(1e100) + xpn(1e-100)) * (xpn(1e-100) + xpn(1.0));
+		cout<<"Test expansion product of sums is exact(true): "<<((wide - (xpn(1e100)*xpn(1e-100)) - xpn(1e100) - (xpn(1e-100)*xpn(1e-100)) - xpn(1e-100)).sign() == 0)<<endl;
+		cout<<"Test expansion sign of near-cancelling sum(true): "<<(((xpn(0.1) + xpn(0.2)) - xpn(0.3)).sign() == 1)<<endl;
+		cout<<"Test expansion sign of near-cancelling sum(false): "<<(((xpn(0.1) + xpn(0.2)) - xpn(0.3)).sign() == -1)<<endl;
+		cout<<"Test expansion comparison(true): "<<((xpn(0.3) < (xpn(0.1) + xpn(0.2))) && !(xpn(0.3) > (xpn(0.1) + xpn(0.2))))<<endl;
+	}
+	cout<<"Test expansion signs agree with exact arithmetic(true): "<<expansion_signs_agree()<<endl;
+	cout<<"Test expansion capacity bounds the arena used(true): "<<expansion_capacity_holds()<<endl;
+	// Test that the exact tests reuse the storage of the arena
 	obj_A.clear_statistics();
+	for(int i = 0; i < 1000; ++i){
+		double t = 0.1 * i;
+		obj_A.side_of_oriented_circle(point(t,t),point(t+0.2,t),point(t+0.2,t+0.2),point(t,t+0.2));
+	}
 	obj_A.get_statistics(st);
-	cout<<"Cleared statistics: ort tot="<<(st.orientation_total_count)<<" ort ex="<<(st.orientation_exact_count)<<" pd tot="<<(st.preferred_direction_total_count)<<" pd ex="<<(st.preferred_direction_exact_count)<<" crc tot="<<(st.side_of_oriented_circle_total_count)<<" crc ex="<<(st.side_of_oriented_circle_exact_count)<<endl;
+	cout<<"Test exact tests make no heap allocations(true): "<<((st.side_of_oriented_circle_exact_count > 0) && (st.side_of_oriented_circle_exact_allocation_count == 0))<<endl;
 
 
 
@@ -0,0 +1,48 @@
+#include <CGAL/MP_Float.h>
+#include"ra/lazy_exact.hpp"
+#include<iostream>
+
+int main(){
+	using lzy = typename ra::math::lazy_exact<double,CGAL::MP_Float>;
+	using stat = typename ra::math::lazy_exact<double,CGAL::MP_Float>::statistics;
+	using std::cout;
+	using std::endl;
+
+	// Test construction and approximation
+	lzy obj_A;
+	lzy obj_B(0.1);
+	cout<<"obj_A: "<<obj_A<<endl;
+	cout<<"obj_B: "<<obj_B<<endl;
+	// Test sign with a determinate approximation
+	lzy obj_C = (obj_B * obj_B) + obj_B;
+	cout<<"Pos sign: "<<(obj_C.sign())<<endl;
+	cout<<"Neg sign: "<<((obj_A - obj_C).sign())<<endl;
+	// Test sign with an indeterminate approximation
+	lzy obj_D(0.3);
+	lzy obj_E = ((obj_B + obj_B) + obj_B) - obj_D;
+	lzy obj_F = (obj_B * lzy(3.0)) - obj_D;
+	lzy obj_G = (obj_B * obj_B) - lzy(0.1*0.1);
+	cout<<"Exact sign of 0.1+0.1+0.1-0.3: "<<(obj_E.sign())<<endl;
+	cout<<"Exact sign of 0.1*3-0.3: "<<(obj_F.sign())<<endl;
+	cout<<"Exact sign of 0.1*0.1-fl(0.1*0.1): "<<(obj_G.sign())<<endl;
+	cout<<"Zero sign: "<<((obj_E - obj_E).sign())<<endl;
+	// Test caching of exact values on shared nodes
+	stat st;
+	lzy::clear_statistics();
+	lzy obj_H = obj_G * obj_G;
+	cout<<"Exact sign of shared node: "<<(obj_H.sign())<<endl;
+	lzy::get_statistics(st);
+	cout<<"get_statistics after reuse: signs="<<(st.exact_sign_count)<<" nodes="<<(st.exact_node_count)<<endl;
+	// Test that only the uncertain factor of a product is evaluated
+	lzy::clear_statistics();
+	lzy obj_I = ((obj_B + obj_B) + obj_B) - obj_D;
+	lzy obj_J = obj_I * ((obj_B * obj_D) + obj_D);
+	cout<<"Exact sign of product: "<<(obj_J.sign())<<endl;
+	lzy::get_statistics(st);
+	cout<<"Exact nodes of product (3): "<<(st.exact_node_count)<<endl;
+	lzy::clear_statistics();
+	lzy::get_statistics(st);
+	cout<<"clear_statistics: signs="<<(st.exact_sign_count)<<" nodes="<<(st.exact_node_count)<<endl;
+
+	return 0;
+}
@@ -0,0 +1,80 @@
+#include"trilib/lop.hpp"
+#include<iostream>
+#include<vector>
+#include<cstdint>
+
+int main(){
+	using std::cout;
+	using std::endl;
+	// A 6 by 6 grid of integer points, with each cell split along the same diagonal
+	const int n = 6;
+	std::vector<double> coordinates;
+	std::vector<std::int32_t> faces;
+	for(int i = 0; i < n; ++i){
+		for(int j = 0; j < n; ++j){ coordinates.insert(coordinates.end(), {double(i), double(j)}); }
+	}
+	for(int i = 0; i + 1 < n; ++i){
+		for(int j = 0; j + 1 < n; ++j){
+			faces.insert(faces.end(), {i*n+j, (i+1)*n+j, (i+1)*n+j+1});
+			faces.insert(faces.end(), {i*n+j, (i+1)*n+j+1, i*n+j+1});
+		}
+	}
+	std::vector<std::int32_t> result(faces.size());
+
+	// Test pd_delaunay_triangulate
+	trilib::Lop_options options;
+	options.v[1] = -1.0;
+	trilib::Lop_result st = trilib::pd_delaunay_triangulate(coordinates, faces, result, options);
+	cout<<"Test triangulate with flips(true): "<<(st.ok && (st.flip_count == std::size_t((n-1)*(n-1))))<<endl;
+	std::vector<std::int32_t> again(faces.size());
+	trilib::Lop_result st_again = trilib::pd_delaunay_triangulate(coordinates, result, again, options);
+	cout<<"Test triangulate result again(true): "<<(st_again.ok && (st_again.flip_count == 0))<<endl;
+	trilib::Lop_result st_other = trilib::pd_delaunay_triangulate(coordinates, faces, faces);
+	cout<<"Test triangulate in place for default directions(true): "<<(st_other.ok && (st_other.flip_count == 0) && (faces.size() == result.size()))<<endl;
+	options.schedule = trilib::Schedule::priority;
+	options.validation = trilib::Validation::trusted;
+	options.spatial_sort = true;
+	st_again = trilib::pd_delaunay_triangulate(coordinates, faces, again, options);
+	cout<<"Test triangulate with other options(true): "<<(st_again.ok && (st_again.flip_count == st.flip_count))<<endl;
+	// Test a run stopped by its budget, resumed from its remaining edges
+	trilib::Lop_options limited(options);
+	limited.budget.max_flips = 7;
+	std::vector<std::int32_t> partial(faces.size());
+	std::vector<std::int32_t> remaining(2 * (coordinates.size() / 2 + faces.size() / 3 - 1));
+	trilib::Lop_result st_limited = trilib::pd_delaunay_triangulate(coordinates, faces, partial, limited, remaining);
+	cout<<"Test triangulate within budget(false): "<<(st_limited.complete)<<endl;
+	remaining.resize(2 * st_limited.remaining_count);
+	limited.budget.max_flips = 0;
+	limited.resume = true;
+	limited.resume_edges = trilib::span<const std::int32_t>(remaining.data(), remaining.size());
+	trilib::Lop_result st_resumed = trilib::pd_delaunay_triangulate(coordinates, partial, partial, limited);
+	cout<<"Test triangulate resumed(true): "<<(st_limited.ok && (st_limited.flip_count == 7) && (st_limited.remaining_count > 0) &&
+	  st_resumed.ok && st_resumed.complete && (st_limited.flip_count + st_resumed.flip_count == st.flip_count) &&
+	  (trilib::pd_delaunay_triangulate(coordinates, partial, again, options).flip_count == 0))<<endl;
+	// Test invalid arguments
+	std::vector<std::int32_t> small(faces.size() - 3);
+	cout<<"Test triangulate with small result(false): "<<(trilib::pd_delaunay_triangulate(coordinates, faces, small).ok)<<endl;
+	std::vector<std::int32_t> bad(faces);
+	bad[0] = n*n;
+	cout<<"Test triangulate with invalid index(false): "<<(trilib::pd_delaunay_triangulate(coordinates, bad, again).ok)<<endl;
+	// Test invalid meshes, which are rejected at every level of validation
+	std::vector<std::int32_t> duplicate(faces);
+	duplicate.insert(duplicate.end(), faces.begin(), faces.begin() + 3);
+	// A third face on the interior edge from (1,0) to (1,1), with a new vertex
+	std::vector<double> extended(coordinates);
+	extended.insert(extended.end(), {2.5, -1.0});
+	std::vector<std::int32_t> non_manifold(faces);
+	non_manifold.insert(non_manifold.end(), {n, n*n, n+1});
+	std::vector<std::int32_t> no_faces;
+	for(auto validation : {trilib::Validation::full, trilib::Validation::topology, trilib::Validation::trusted}){
+		trilib::Lop_options checked;
+		checked.validation = validation;
+		std::vector<std::int32_t> out_duplicate(duplicate.size());
+		std::vector<std::int32_t> out_non_manifold(non_manifold.size());
+		std::vector<std::int32_t> out_no_faces;
+		cout<<"Test triangulate with duplicate face(false): "<<(trilib::pd_delaunay_triangulate(coordinates, duplicate, out_duplicate, checked).ok)<<endl;
+		cout<<"Test triangulate with non-manifold edge(false): "<<(trilib::pd_delaunay_triangulate(extended, non_manifold, out_non_manifold, checked).ok)<<endl;
+		cout<<"Test triangulate with no faces(false): "<<(trilib::pd_delaunay_triangulate(coordinates, no_faces, out_no_faces, checked).ok)<<endl;
+	}
+	cout<<"Statistics: flips="<<(st.flip_count)<<" suspects="<<(st.suspect_push_count)<<" tests="<<(st.test_count)<<" fq tot="<<(st.flippable_quad_total_count)<<" pde tot="<<(st.locally_pd_delaunay_edge_total_count)<<" pde tie="<<(st.locally_pd_delaunay_edge_tie_count)<<endl;
+}
@@ -0,0 +1,552 @@
+#include <CGAL/Simple_cartesian.h>
+#include"ra/kernel.hpp"
+#include"ra/alloc_profile.hpp"
+#include"triangulation_2.hpp"
+#include"pd_delaunay.hpp"
+#include"dc_delaunay.hpp"
+#include"compressed_io.hpp"
+#include"mesh_generator.hpp"
+#include"run_report.hpp"
+#include<iostream>
+#include<sstream>
+#include<random>
+#include<array>
+#include<vector>
+#include<algorithm>
+#include<cstdint>
+#include<limits>
+#include<thread>
+
+using Kernel = CGAL::Simple_cartesian<double>;
+using kernel = ra::geometry::Kernel<double>;
+using Triangulation = trilib::Triangulation_2<Kernel>;
+using point = CGAL::Simple_cartesian<double>::Point_2;
+using vector = CGAL::Simple_cartesian<double>::Vector_2;
+
+// Makes an n by n grid of integer points, with each cell split along the
+// same diagonal.
+std::string make_grid(int n){
+	std::ostringstream out;
+	out<<"OFF\n"<<(n*n)<<" "<<(2*(n-1)*(n-1))<<" 0\n";
+	for(int i = 0; i < n; ++i){
+		for(int j = 0; j < n; ++j){ out<<i<<" "<<j<<" 0\n"; }
+	}
+	for(int i = 0; i + 1 < n; ++i){
+		for(int j = 0; j + 1 < n; ++j){
+			out<<"3 "<<(i*n+j)<<" "<<((i+1)*n+j)<<" "<<((i+1)*n+j+1)<<"\n";
+			out<<"3 "<<(i*n+j)<<" "<<((i+1)*n+j+1)<<" "<<(i*n+j+1)<<"\n";
+		}
+	}
+	return out.str();
+}
+
+// Writes a generated mesh in OFF format, with enough digits to read back
+// exactly the coordinates of the mesh.
+std::string make_off(const trilib::generator::Mesh& mesh){
+	std::ostringstream out;
+	out.precision(17);
+	out<<"OFF\n"<<mesh.num_vertices()<<" "<<mesh.num_faces()<<" 0\n";
+	for(int i = 0; i < mesh.num_vertices(); ++i){ out<<mesh.coordinates[2*i]<<" "<<mesh.coordinates[2*i+1]<<" 0\n"; }
+	for(int i = 0; i < mesh.num_faces(); ++i){ out<<"3 "<<mesh.faces[3*i]<<" "<<mesh.faces[3*i+1]<<" "<<mesh.faces[3*i+2]<<"\n"; }
+	return out.str();
+}
+
+// Tests if the triangulation is valid (i.e., its faces are counterclockwise,
+// its border is convex, and its counts satisfy Euler's formula).
+bool is_valid(Triangulation& tri, const kernel& obj){
+	using ort = kernel::Orientation;
+	for(auto f = tri.faces_begin(); f != tri.faces_end(); ++f){
+		auto h = f->halfedge();
+		if(h->next()->next()->next() != h){ return false; }
+		if(obj.orientation(h->vertex()->point(), h->next()->vertex()->point(), h->next()->next()->vertex()->point()) != ort::left_turn){ return false; }
+	}
+	for(auto h = tri.halfedges_begin(); h != tri.halfedges_end(); ++h){
+		if( (h->next()->prev() != &*h) || (h->opposite()->opposite() != &*h) ){ return false; }
+		if( h->is_border() && (obj.orientation(h->prev()->vertex()->point(), h->vertex()->point(), h->next()->vertex()->point()) == ort::left_turn) ){ return false; }
+	}
+	for(auto v = tri.vertices_begin(); v != tri.vertices_end(); ++v){
+		if(v->halfedge()->vertex() != &*v){ return false; }
+	}
+	return (tri.size_of_vertices() - tri.size_of_edges() + tri.size_of_faces()) == 1;
+}
+
+// Tests if the triangulation is preferred-directions Delaunay (i.e., the
+// LOP performs no flips).
+bool is_pd_delaunay(Triangulation& tri, const kernel& obj, const vector& u, const vector& v){
+	return (trilib::pd_delaunay_lop(tri,obj,u,v).flip_count == 0);
+}
+
+using trilib::generator::sorted_faces;
+
+int main(){
+	using std::cout;
+	using std::endl;
+	kernel obj_A;
+	vector u(1,0); vector v(1,1);
+	std::istringstream in(make_grid(6));
+	Triangulation tri(in);
+
+	// Test certify_pd_delaunay
+	auto cert = trilib::certify_pd_delaunay(tri,obj_A,u,vector(1,-1),3);
+	cout<<"Test certify for other directions(false): "<<(cert.violations.empty())<<endl;
+	trilib::pd_delaunay_lop(tri,obj_A,u,v);
+	cert = trilib::certify_pd_delaunay(tri,obj_A,u,v,3);
+	cout<<"Test certify after LOP(true): "<<(cert.violations.empty() && (cert.edge_count == std::size_t(tri.size_of_edges())))<<endl;
+	kernel::clear_statistics();
+	cert = trilib::certify_pd_delaunay(tri,obj_A,u,v,3);
+	kernel::Statistics cert_stat;
+	kernel::get_statistics(cert_stat);
+	cout<<"Test certify merges kernel statistics of threads(true): "<<(cert_stat.flippable_quad_total_count == cert.interior_edge_count)<<endl;
+	// Test that the ranges of parallel_for_each_edge cover every edge
+	// once, in storage order, whichever end each range is found from
+	{
+		std::vector<Triangulation::Halfedge_const_handle> stored;
+		for(auto h = tri.halfedges_begin(); h != tri.halfedges_end(); ++++h){ stored.push_back(h); }
+		bool covered = true;
+		for(int num_threads : {1, 2, 3, 5, 8, 1000}){
+			std::vector<std::vector<Triangulation::Halfedge_const_handle>> ranges(num_threads);
+			tri.parallel_for_each_edge([&ranges](Triangulation::Halfedge_const_handle h, int i){ ranges[i].push_back(h); }, num_threads);
+			std::vector<Triangulation::Halfedge_const_handle> visited;
+			for(const auto& range : ranges){ visited.insert(visited.end(), range.begin(), range.end()); }
+			covered = covered && (visited == stored);
+		}
+		cout<<"Test parallel edge ranges cover the edges in order(true): "<<covered<<endl;
+	}
+
+	// Test the validation levels with a face of incorrect orientation
+	const std::string folded("OFF\n4 3 0\n0 0 0\n4 0 0\n2 4 0\n2 -1 0\n3 0 1 3\n3 1 2 3\n3 2 0 3\n");
+	Triangulation checked;
+	std::istringstream folded_in(folded);
+	cout<<"Test full validation of folded mesh(false): "<<(checked.input_off(folded_in))<<endl;
+	checked.set_validation(Triangulation::Validation::topology);
+	folded_in.clear(); folded_in.str(folded);
+	cout<<"Test topology validation of folded mesh(true): "<<(checked.input_off(folded_in))<<endl;
+	checked.set_validation(Triangulation::Validation::trusted);
+	folded_in.clear(); folded_in.str(folded);
+	cout<<"Test trusted load of folded mesh(true): "<<(checked.input_off(folded_in) && (checked.size_of_faces() == 3))<<endl;
+	// Test that the orientation checks of full validation on several
+	// threads add the kernel statistics of the threads to the caller's
+	{
+		trilib::generator::Mesh mesh = trilib::generator::make_grid_mesh(200, 0.0, 1);
+		std::vector<std::size_t> counts;
+		for(int num_threads : {1, 4}){
+			Triangulation grid;
+			grid.set_num_threads(num_threads);
+			kernel::clear_statistics();
+			bool built = grid.input_arrays(mesh.coordinates.data(), mesh.num_vertices(), mesh.faces.data(), mesh.num_faces());
+			kernel::Statistics build_stat;
+			kernel::get_statistics(build_stat);
+			counts.push_back(built ? std::size_t(build_stat.orientation_total_count) : 0);
+		}
+		cout<<"Test threaded validation merges kernel statistics(true): "<<((counts[0] >= std::size_t(mesh.num_faces())) && (counts[0] == counts[1]))<<endl;
+	}
+
+	// Test that the coordinates written in OFF format are read back exactly
+	{
+		std::istringstream thirds_in("OFF\n3 1 0\n0 0 0\n0.1 0 0\n0.1 0.3333333333333333 0\n3 0 1 2\n");
+		Triangulation thirds(thirds_in);
+		std::ostringstream thirds_out;
+		thirds_out.precision(3);
+		thirds.output_off(thirds_out);
+		std::istringstream reread_in(thirds_out.str());
+		Triangulation reread(reread_in);
+		std::vector<point> before;
+		std::vector<point> after;
+		for(auto vh : thirds.output_vertices()){ before.push_back(vh->point()); }
+		for(auto vh : reread.output_vertices()){ after.push_back(vh->point()); }
+		cout<<"Test OFF output reads back exactly(true): "<<((before == after) && (thirds_out.precision() == 3))<<endl;
+	}
+
+	// Test that invalid meshes are rejected (at every validation level)
+	// instead of aborting
+	const std::string square("OFF\n4 ");
+	const std::string corners("0 0 0\n1 0 0\n1 1 0\n0 1 0\n");
+	const std::vector<std::pair<const char*, std::string>> invalid = {
+		{"duplicate face", square + "3 0\n" + corners + "3 0 1 2\n3 0 2 3\n3 0 1 2\n"},
+		{"non-manifold edge", "OFF\n5 3 0\n" + corners + "2 2 0\n3 0 1 2\n3 0 2 3\n3 2 0 4\n"},
+		{"face and its reverse", square + "2 0\n" + corners + "3 0 1 2\n3 0 2 1\n"},
+		{"repeated vertex", square + "2 0\n" + corners + "3 0 1 2\n3 0 0 3\n"},
+		{"no faces", square + "0 0\n" + corners},
+		{"no vertices", "OFF\n0 0 0\n"},
+	};
+	for(const auto& mesh : invalid){
+		bool accepted = false;
+		for(auto validation : {Triangulation::Validation::full, Triangulation::Validation::topology, Triangulation::Validation::trusted}){
+			checked.set_validation(validation);
+			std::istringstream mesh_in(mesh.second);
+			accepted = checked.input_off(mesh_in) || accepted;
+		}
+		cout<<"Test "<<mesh.first<<" is rejected(false): "<<accepted<<endl;
+	}
+	{
+		// The counts of a binary mesh are not trusted to size its arrays.
+		std::int32_t counts[2] = {std::int32_t(1) << 30, std::int32_t(1) << 30};
+		std::string header = std::string("BTRI") + std::string(reinterpret_cast<const char*>(counts), sizeof(counts));
+		std::istringstream binary_in(header + std::string(64, '\0'));
+		cout<<"Test binary mesh with counts beyond its data(false): "<<(checked.input_binary(binary_in))<<endl;
+	}
+	checked.set_validation(Triangulation::Validation::full);
+
+	// Test that the schedules of the LOP give the same triangulation, on a
+	// grid and on a mesh whose flips interact
+	std::vector<std::array<int,3>> lifo_result;
+	for(trilib::Schedule schedule : {trilib::Schedule::lifo, trilib::Schedule::fifo, trilib::Schedule::spatial, trilib::Schedule::priority}){
+		std::istringstream grid_in(make_grid(8));
+		Triangulation grid(grid_in);
+		trilib::Lop_statistics lop = trilib::pd_delaunay_lop(grid,obj_A,u,vector(1,-1),schedule);
+		if(schedule == trilib::Schedule::lifo){ lifo_result = sorted_faces(grid); }
+		cout<<"Test schedule "<<trilib::schedule_name(schedule)<<"(true): "<<((sorted_faces(grid) == lifo_result) && (lop.flip_count > 0) && (lop.test_count >= lop.flip_count) && trilib::certify_pd_delaunay(grid,obj_A,u,vector(1,-1),1).violations.empty())<<endl;
+	}
+	{
+		trilib::generator::Mesh mesh = trilib::generator::make_sweep_mesh(500, 1);
+		std::vector<std::array<int,3>> reference;
+		for(trilib::Schedule schedule : {trilib::Schedule::lifo, trilib::Schedule::fifo, trilib::Schedule::spatial, trilib::Schedule::priority}){
+			Triangulation swept;
+			bool built = swept.input_arrays(mesh.coordinates.data(), mesh.num_vertices(), mesh.faces.data(), mesh.num_faces());
+			trilib::Lop_statistics lop = trilib::pd_delaunay_lop(swept,obj_A,u,vector(1,-1),schedule);
+			if(schedule == trilib::Schedule::lifo){ reference = sorted_faces(swept); }
+			cout<<"Test schedule "<<trilib::schedule_name(schedule)<<" with interacting flips(true): "<<(built && (sorted_faces(swept) == reference)
+			  && (lop.flip_count > std::size_t(swept.size_of_edges())) && trilib::certify_pd_delaunay(swept,obj_A,u,vector(1,-1),1).violations.empty())<<endl;
+		}
+	}
+
+	// Test that the priority of an edge does not depend on the size of its
+	// quadrilateral
+	{
+		std::istringstream small_in("OFF\n4 2 0\n0 0 0\n3 0 0\n2 3 0\n0 1 0\n3 0 1 2\n3 0 2 3\n");
+		std::istringstream large_in("OFF\n4 2 0\n0 0 0\n3000 0 0\n2000 3000 0\n0 1000 0\n3 0 1 2\n3 0 2 3\n");
+		Triangulation small(small_in);
+		Triangulation large(large_in);
+		auto interior = [](Triangulation& quad){
+			auto h = quad.halfedges_begin();
+			while(h->is_border_edge()){ ++h; }
+			return Triangulation::Halfedge_handle(h);
+		};
+		double small_key = trilib::incircle_excess<Triangulation,kernel>(interior(small));
+		double large_key = trilib::incircle_excess<Triangulation,kernel>(interior(large));
+		cout<<"Test priority is independent of scale(true): "<<((small_key != 0.0) && (std::abs(large_key - small_key) <= 1e-12 * std::abs(small_key)))<<endl;
+	}
+
+	// Test the anytime LOP: stop after a number of flips, then by the
+	// progress callback, and resume from the work-list each time
+	for(trilib::Schedule schedule : {trilib::Schedule::lifo, trilib::Schedule::fifo, trilib::Schedule::spatial, trilib::Schedule::priority}){
+		std::istringstream grid_in(make_grid(8));
+		Triangulation grid(grid_in);
+		trilib::Lop_statistics lop{0,0,0};
+		trilib::Lop_worklist<Triangulation> worklist;
+		trilib::Lop_budget budget;
+		budget.max_flips = 10;
+		bool stopped = !trilib::pd_delaunay_lop(grid,obj_A,u,vector(1,-1),schedule,budget,worklist,lop);
+		stopped = stopped && (lop.flip_count == 10) && !worklist.edges.empty() && is_valid(grid,obj_A);
+		std::size_t calls = 0;
+		budget.max_flips = 0;
+		budget.progress_interval = 1;
+		budget.progress = [&calls](const trilib::Lop_progress& progress){
+			++calls;
+			return (progress.flip_count < 20);
+		};
+		stopped = stopped && !trilib::resume_pd_delaunay_lop(grid,obj_A,u,vector(1,-1),budget,worklist,lop) && (lop.flip_count == 20) && (calls > 0);
+		bool complete = trilib::resume_pd_delaunay_lop(grid,obj_A,u,vector(1,-1),trilib::Lop_budget(),worklist,lop) && worklist.edges.empty();
+		cout<<"Test anytime "<<trilib::schedule_name(schedule)<<" stops valid(true): "<<stopped<<endl;
+		cout<<"Test anytime "<<trilib::schedule_name(schedule)<<" resumes to same result(true): "<<(complete && (lop.flip_count == 49) && (sorted_faces(grid) == lifo_result))<<endl;
+	}
+	{
+		// The time of the budget is checked before the first test (and
+		// includes the collection of the suspect edges)
+		std::istringstream grid_in(make_grid(8));
+		Triangulation grid(grid_in);
+		trilib::Lop_statistics lop{0,0,0};
+		trilib::Lop_worklist<Triangulation> worklist;
+		trilib::Lop_budget budget;
+		budget.max_seconds = 1e-12;
+		bool complete = trilib::pd_delaunay_lop(grid,obj_A,u,vector(1,-1),trilib::Schedule::lifo,budget,worklist,lop);
+		cout<<"Test anytime stops at once when out of time(true): "<<(!complete && (lop.test_count == 0) && !worklist.edges.empty())<<endl;
+	}
+
+	// Test locate
+	using loc = trilib::Location_type;
+	cout<<"Test locate face(true): "<<(trilib::locate(tri,obj_A,point(2.25,3.5)).type == loc::face)<<endl;
+	cout<<"Test locate edge(true): "<<(trilib::locate(tri,obj_A,point(2.5,3)).type == loc::edge)<<endl;
+	cout<<"Test locate vertex(true): "<<(trilib::locate(tri,obj_A,point(2,3)).type == loc::vertex)<<endl;
+	cout<<"Test locate outside(true): "<<(trilib::locate(tri,obj_A,point(7,3)).type == loc::outside)<<endl;
+
+	// Test insert_vertex
+	trilib::Lop_statistics st{0,0,0};
+	auto va = trilib::insert_vertex(tri,obj_A,u,v,point(2.25,3.5),Triangulation::Face_handle(),&st);
+	auto vb = trilib::insert_vertex(tri,obj_A,u,v,point(0,2.5),Triangulation::Face_handle(),&st);
+	cout<<"Test insert in face(true): "<<(va != Triangulation::Vertex_handle())<<endl;
+	cout<<"Test insert on border edge(true): "<<(vb != Triangulation::Vertex_handle())<<endl;
+	cout<<"Test insert at vertex(false): "<<(trilib::insert_vertex(tri,obj_A,u,v,point(2,3)) != Triangulation::Vertex_handle())<<endl;
+	cout<<"Test insert outside(false): "<<(trilib::insert_vertex(tri,obj_A,u,v,point(-1,3)) != Triangulation::Vertex_handle())<<endl;
+	cout<<"Test valid and pd delaunay after insert(true): "<<(is_valid(tri,obj_A) && is_pd_delaunay(tri,obj_A,u,v))<<endl;
+
+	// Test move_vertex
+	auto vc = trilib::move_vertex(tri,obj_A,u,v,va,point(2.3,3.4),&st);
+	auto vd = trilib::move_vertex(tri,obj_A,u,v,vc,point(4.5,0.5),&st);
+	cout<<"Test move in place(true): "<<(vc == va)<<endl;
+	cout<<"Test move by reinsertion(true): "<<( (vd != Triangulation::Vertex_handle()) && (vd->point() == point(4.5,0.5)) )<<endl;
+	cout<<"Test move outside(false): "<<(trilib::move_vertex(tri,obj_A,u,v,vd,point(9,9)) != Triangulation::Vertex_handle())<<endl;
+	cout<<"Test valid and pd delaunay after move(true): "<<(is_valid(tri,obj_A) && is_pd_delaunay(tri,obj_A,u,v))<<endl;
+
+	// Test remove_vertex
+	cout<<"Test remove interior(true): "<<(trilib::remove_vertex(tri,obj_A,u,v,vd,&st))<<endl;
+	cout<<"Test remove border(true): "<<(trilib::remove_vertex(tri,obj_A,u,v,vb,&st))<<endl;
+	cout<<"Test valid and pd delaunay after remove(true): "<<(is_valid(tri,obj_A) && is_pd_delaunay(tri,obj_A,u,v))<<endl;
+	auto corner = trilib::locate(tri,obj_A,point(0,0)).halfedge->vertex();
+	cout<<"Test remove corner(true): "<<(trilib::remove_vertex(tri,obj_A,u,v,corner,&st))<<endl;
+	cout<<"Test valid and pd delaunay after remove corner(true): "<<(is_valid(tri,obj_A) && is_pd_delaunay(tri,obj_A,u,v))<<endl;
+
+	// Test random edits on perturbed points
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<double> coord(0.0,5.0);
+	bool valid = true;
+	for(int i = 0; i < 200; ++i){
+		trilib::insert_vertex(tri,obj_A,u,v,point(coord(gen),coord(gen)),Triangulation::Face_handle(),&st);
+	}
+	for(int i = 0; i < 100; ++i){
+		auto vi = tri.vertices_begin();
+		for(int j = gen() % tri.size_of_vertices(); j > 0; --j){ ++vi; }
+		if(gen() % 2){ trilib::remove_vertex(tri,obj_A,u,v,&*vi,&st); }
+		else{ trilib::move_vertex(tri,obj_A,u,v,&*vi,point(coord(gen),coord(gen)),&st); }
+		valid = valid && is_valid(tri,obj_A);
+	}
+	cout<<"Test certify after random edits(true): "<<(trilib::certify_pd_delaunay(tri,obj_A,u,v,4).violations.empty())<<endl;
+	cout<<"Test valid and pd delaunay after random edits(true): "<<(valid && is_pd_delaunay(tri,obj_A,u,v))<<endl;
+	cout<<"Edit statistics: flips="<<(st.flip_count)<<" suspects="<<(st.suspect_push_count)<<endl;
+
+	// Test dc_pd_delaunay on a grid (where every quadrilateral is
+	// cocircular) against the LOP, for both tie-breaks
+	for(const vector& w : {vector(1,1), vector(1,-1)}){
+		std::istringstream grid_in(make_grid(9));
+		Triangulation tri_L(grid_in);
+		trilib::pd_delaunay_lop(tri_L,obj_A,u,w);
+		std::vector<double> coords;
+		for(int i = 0; i < 9; ++i){
+			for(int j = 0; j < 9; ++j){ coords.insert(coords.end(), {double(i), double(j)}); }
+		}
+		Triangulation tri_D;
+		trilib::Lop_statistics dc_st{0,0,0};
+		bool built = trilib::dc_pd_delaunay(tri_D,obj_A,u,w,coords.data(),81,2,&dc_st);
+		cout<<"Test divide and conquer on grid equals LOP(true): "<<(built && is_valid(tri_D,obj_A) && (sorted_faces(tri_D) == sorted_faces(tri_L)))<<endl;
+	}
+	// Test dc_pd_delaunay on random points, with and without threads
+	{
+		std::mt19937 gen_D(2);
+		std::uniform_real_distribution<double> coord_D(0.0,1.0);
+		std::vector<double> coords;
+		for(int i = 0; i < 80000; ++i){ coords.push_back(coord_D(gen_D)); }
+		Triangulation tri_S;
+		Triangulation tri_T;
+		bool built = trilib::dc_pd_delaunay(tri_S,obj_A,u,v,coords.data(),40000,1) && trilib::dc_pd_delaunay(tri_T,obj_A,u,v,coords.data(),40000,4);
+		cout<<"Test divide and conquer on random points(true): "<<(built && is_valid(tri_T,obj_A) && trilib::certify_pd_delaunay(tri_T,obj_A,u,v,2).violations.empty())<<endl;
+		cout<<"Test divide and conquer with threads(true): "<<(built && (sorted_faces(tri_S) == sorted_faces(tri_T)))<<endl;
+		std::vector<double> collinear{0,0, 1,1, 2,2, 3,3};
+		cout<<"Test divide and conquer on collinear points(false): "<<(trilib::dc_pd_delaunay(tri_S,obj_A,u,v,collinear.data(),4,1))<<endl;
+		std::vector<double> duplicate{0,0, 1,0, 0,1, 1,0};
+		cout<<"Test divide and conquer on duplicate points(false): "<<(trilib::dc_pd_delaunay(tri_S,obj_A,u,v,duplicate.data(),4,1))<<endl;
+	}
+
+	// Test float storage against double storage of the same (float) values
+	{
+		trilib::generator::Mesh grid = trilib::generator::make_grid_mesh(12, 0.3, 3);
+		for(double& c : grid.coordinates){ c = double(float(0.1 * c)); }
+		const std::string mesh = make_off(grid);
+		using Float_triangulation = trilib::Triangulation_2<CGAL::Simple_cartesian<float>>;
+		using Float_vector = Float_triangulation::Vector;
+		std::istringstream in_D(mesh);
+		std::istringstream in_F(mesh);
+		Triangulation tri_D;
+		Float_triangulation tri_F;
+		bool loaded = tri_D.input_off(in_D) && tri_F.input_off(in_F);
+		trilib::Lop_statistics st_D = trilib::pd_delaunay_lop(tri_D,obj_A,u,v);
+		trilib::Lop_statistics st_F = trilib::pd_delaunay_lop(tri_F,obj_A,Float_vector(1,0),Float_vector(1,1));
+		std::ostringstream out_D;
+		std::ostringstream out_F;
+		tri_D.output_off(out_D);
+		tri_F.output_off(out_F);
+		cout<<"Test float storage equals double storage(true): "<<(loaded && (st_D.flip_count > 0) && (st_D.flip_count == st_F.flip_count) && (out_D.str() == out_F.str()))<<endl;
+		cout<<"Test float points are smaller(true): "<<(sizeof(Float_triangulation::Point) < sizeof(Triangulation::Point))<<endl;
+	}
+
+	// Test the vertex cache against the points, on a grid scaled by 0.1
+	// (whose cocircular cells the semi-static filter leaves to the other
+	// paths) and on a jittered grid
+	using Cached_triangulation = trilib::Triangulation_2<Kernel, true>;
+	for(double jitter : {0.0, 0.3}){
+		vector w(1,-1);
+		trilib::generator::Mesh grid = trilib::generator::make_grid_mesh(12, jitter, 5);
+		for(double& c : grid.coordinates){ c *= 0.1; }
+		const std::string mesh = make_off(grid);
+		std::istringstream in_U(mesh);
+		std::istringstream in_C(mesh);
+		std::istringstream in_L(mesh);
+		Triangulation tri_U;
+		Cached_triangulation tri_C;
+		Cached_triangulation tri_L;
+		bool loaded = tri_U.input_off(in_U) && tri_C.input_off(in_C) && tri_L.input_off(in_L);
+		kernel::Statistics before;
+		kernel::Statistics after;
+		trilib::Lop_statistics st_U = trilib::pd_delaunay_lop(tri_U,obj_A,u,w);
+		kernel::get_statistics(before);
+		trilib::Lop_statistics st_C = trilib::pd_delaunay_lop(tri_C,obj_A,u,w);
+		kernel::get_statistics(after);
+		trilib::Lop_statistics st_L = trilib::pd_delaunay_lop(tri_L,obj_A,u,w,trilib::Schedule::spatial);
+		std::ostringstream out_U;
+		std::ostringstream out_C;
+		std::ostringstream out_L;
+		tri_U.output_off(out_U);
+		tri_C.output_off(out_C);
+		tri_L.output_off(out_L);
+		std::size_t semi_static = after.flippable_quad_semi_static_count - before.flippable_quad_semi_static_count;
+		cout<<"Test vertex cache with jitter "<<jitter<<" equals points(true): "<<(loaded && (st_U.flip_count > 0) && (st_U.flip_count == st_C.flip_count) &&
+		  (semi_static > 0) && (semi_static <= st_C.test_count) && (out_U.str() == out_C.str()) && (out_U.str() == out_L.str()) &&
+		  (trilib::pd_delaunay_lop(tri_L,obj_A,u,w).flip_count == 0) && (st_L.test_count > 0))<<endl;
+	}
+	{
+		// The cache is only in the vertices of a cached triangulation, and
+		// set_point keeps it up to date
+		std::istringstream in(make_grid(4));
+		Cached_triangulation tri_C(in);
+		auto vc = tri_C.vertices_begin();
+		tri_C.set_point(vc, point(0.25, -0.5));
+		kernel::Cached_point expected = kernel::make_cached_point(point(0.25, -0.5));
+		bool updated = (vc->cached_point().x() == expected.x()) && (vc->cached_point().y() == expected.y()) &&
+		  (vc->cached_point().lifted_lower == expected.lifted_lower) && (vc->cached_point().lifted_upper == expected.lifted_upper);
+		cout<<"Test vertex cache only in cached triangulations(true): "<<(!Triangulation::vertex_cache() && Cached_triangulation::vertex_cache() &&
+		  (sizeof(Triangulation::Vertex) + sizeof(kernel::Cached_point) <= sizeof(Cached_triangulation::Vertex)))<<endl;
+		cout<<"Test set_point updates vertex cache(true): "<<updated<<endl;
+	}
+
+	// Test the times of the phases of the input
+	{
+		std::istringstream in(make_grid(20));
+		Triangulation tri_T;
+		bool loaded = tri_T.input_off(in);
+		const Triangulation::Input_times& times = tri_T.input_times();
+		bool recorded = (times.parse_seconds > 0) && (times.build_seconds > 0) && (times.validate_seconds > 0);
+		std::vector<double> coordinates{0,0, 1,0, 0,1};
+		std::vector<std::int32_t> faces{0,1,2};
+		loaded = loaded && tri_T.input_arrays(coordinates.data(),3,faces.data(),1);
+		cout<<"Test input times(true): "<<(loaded && recorded && (tri_T.input_times().parse_seconds == 0))<<endl;
+	}
+
+	// Test compressed output and input (in small chunks, so that the
+	// streams hand off many chunks), for the formats that are compiled in
+	for(trilib::io::Compression compression : {trilib::io::Compression::none, trilib::io::Compression::gzip, trilib::io::Compression::zstd}){
+		if(!trilib::io::is_available(compression)){ continue; }
+		std::istringstream in(make_grid(30));
+		Triangulation tri_Z;
+		tri_Z.input_off(in);
+		std::ostringstream plain;
+		tri_Z.output_off(plain);
+		std::ostringstream packed;
+		trilib::io::Output_stream out(packed, compression, 1, 4096);
+		bool written = tri_Z.output_off(out) && out.close();
+		std::istringstream packed_in(packed.str());
+		trilib::io::Input_stream unpacked(packed_in, 4096);
+		Triangulation tri_R;
+		bool read = tri_R.input_off(unpacked) && unpacked.read_to_end() && (unpacked.compression() == compression);
+		// The result must be that of reading the uncompressed output.
+		std::istringstream plain_in(plain.str());
+		Triangulation tri_P;
+		tri_P.input_off(plain_in);
+		std::ostringstream result;
+		std::ostringstream expected;
+		tri_R.output_off(result);
+		tri_P.output_off(expected);
+		cout<<"Test "<<trilib::io::compression_name(compression)<<" round trip(true): "<<(written && read && (result.str() == expected.str()))<<endl;
+		if(compression != trilib::io::Compression::none){
+			std::istringstream truncated_in(packed.str().substr(0, packed.str().size() / 2));
+			trilib::io::Input_stream truncated(truncated_in, 4096);
+			Triangulation tri_T;
+			cout<<"Test "<<trilib::io::compression_name(compression)<<" truncated input(false): "<<(tri_T.input_off(truncated) || truncated.error().empty())<<endl;
+			// Without the end of the compressed data (e.g., the gzip
+			// trailer), the mesh itself may be complete.
+			std::istringstream trailer_in(packed.str().substr(0, packed.str().size() - 8));
+			trilib::io::Input_stream trailer(trailer_in, 4096);
+			Triangulation tri_E;
+			cout<<"Test "<<trilib::io::compression_name(compression)<<" input without end(false): "<<(tri_E.input_off(trailer) && trailer.read_to_end())<<endl;
+		}
+	}
+
+	// Test the JSON writer of the run reports
+	{
+		trilib::report::Report report;
+		report.set("run", "name", "a\"b\\c\nd");
+		report.set("run", "count", std::size_t(3));
+		report.set("phase_seconds", "nan", std::numeric_limits<double>::quiet_NaN());
+		report.set("phase_seconds", "inf", -std::numeric_limits<double>::infinity());
+		report.set("phase_seconds", "half", 0.5);
+		report.set("run", "count", std::size_t(4));
+		report.set("run", "ok", true);
+		std::ostringstream out;
+		report.write_json(out);
+		cout<<"Test report JSON(true): "<<(out.str() ==
+		  "{\"run\":{\"name\":\"a\\\"b\\\\c\\u000ad\",\"count\":4,\"ok\":true},\"phase_seconds\":{\"nan\":null,\"inf\":null,\"half\":0.5}}\n")<<endl;
+	}
+
+	// Test the allocation profiler (which only counts if compiled in)
+	{
+		ra::profile::clear_statistics();
+		std::istringstream in(make_grid(8));
+		Triangulation tri_P;
+		tri_P.input_off(in);
+		trilib::pd_delaunay_lop(tri_P,obj_A,vector(1,0),vector(1,-1));
+		std::ostringstream out;
+		tri_P.output_off(out);
+		ra::profile::Allocation_statistics alloc_stat;
+		ra::profile::get_statistics(alloc_stat);
+		auto count = [&alloc_stat](ra::profile::Region region){ return alloc_stat.regions[static_cast<std::size_t>(region)].allocation_count; };
+		bool counted = (count(ra::profile::Region::parse) > 0) && (count(ra::profile::Region::build) > 0) &&
+		  (count(ra::profile::Region::scan) > 0) && (count(ra::profile::Region::output) > 0);
+		cout<<"Test allocation profile(true): "<<(counted == ra::profile::enabled)<<endl;
+		ra::profile::print_statistics(cout, alloc_stat);
+	}
+	{
+		// A triangulation reused for a mesh as large allocates no new nodes
+		// (on a new thread, whose free lists of nodes start empty)
+		std::size_t first = 0; std::size_t second = 0; std::size_t nodes = 0;
+		std::thread thread([&first, &second, &nodes](){
+			auto build_count = [](){
+				ra::profile::Allocation_statistics alloc_stat;
+				ra::profile::get_statistics(alloc_stat);
+				return alloc_stat.regions[static_cast<std::size_t>(ra::profile::Region::build)].allocation_count;
+			};
+			Triangulation tri_R;
+			std::istringstream in_first(make_grid(8));
+			ra::profile::clear_statistics();
+			tri_R.input_off(in_first);
+			first = build_count();
+			nodes = tri_R.size_of_vertices() + tri_R.size_of_edges() + tri_R.size_of_faces();
+			std::istringstream in_second(make_grid(8));
+			ra::profile::clear_statistics();
+			tri_R.input_off(in_second);
+			second = build_count();
+		});
+		thread.join();
+		cout<<"Test reused triangulation allocates no new nodes(true): "<<(((second + nodes) <= first) == ra::profile::enabled)<<endl;
+	}
+	{
+		// Over-aligned blocks (by the aligned operator new), freed outside
+		// of the region of their allocation
+		struct alignas(64) Wide { double values[8]; };
+		std::vector<Wide> wide;
+		std::vector<int> narrow;
+		ra::profile::clear_statistics();
+		{
+			RA_ALLOC_SCOPE(ra::profile::Region::validate);
+			wide.resize(3);
+			narrow.resize(3);
+		}
+		bool aligned = (reinterpret_cast<std::uintptr_t>(wide.data()) % alignof(Wide) == 0);
+		std::vector<Wide>().swap(wide);
+		std::vector<int>().swap(narrow);
+		ra::profile::Allocation_statistics alloc_stat;
+		ra::profile::get_statistics(alloc_stat);
+		const ra::profile::Allocation_counts& counts = alloc_stat.regions[static_cast<std::size_t>(ra::profile::Region::validate)];
+		bool counted = (counts.allocation_count == 2) && (counts.deallocation_count == 2) && (counts.allocation_bytes >= 3*sizeof(Wide));
+		cout<<"Test allocation profile of aligned blocks freed in another region(true): "<<(aligned && (counted == ra::profile::enabled))<<endl;
+	}
+
+	return 0;
+}
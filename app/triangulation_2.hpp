@@ -35,29 +35,111 @@ reason, care should be taken to provide valid data to the input operation.
 
 #include <cmath>
 #include <cassert>
+#include <cstdint>
+#include <string>
 #include <set>
 #include <map>
+#include <memory>
 #include <vector>
+#include <numeric>
+#include <limits>
+#include <algorithm>
 #include <exception>
-#include <CGAL/Cartesian.h>
+#include <thread>
+#include <chrono>
+#include <type_traits>
+#include <CGAL/Simple_cartesian.h>
 #include <CGAL/Filtered_kernel.h>
 #include <CGAL/HalfedgeDS_items_2.h>
 #include <CGAL/HalfedgeDS_default.h>
 #include <CGAL/HalfedgeDS_decorator.h>
 #include <CGAL/HalfedgeDS_vertex_base.h>
+#include "ra/kernel.hpp"
+#include "trilib/lop.hpp"
+#include "ra/alloc_profile.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace trilib {
 
+////////////////////////////////////////////////////////////////////////////////
+// A helper class for the Trangulation_2 class.
+// The allocator of the vertices, halfedges and faces of the halfedge data
+// structure. Nodes that are freed are kept on a free list of the calling
+// thread and handed out again, so that a triangulation object reused for
+// one mesh after another (e.g., by the service mode) allocates no nodes
+// once the thread has held a mesh as large.
+////////////////////////////////////////////////////////////////////////////////
+
+template <class T>
+class Node_allocator
+{
+public:
+	typedef T value_type;
+	Node_allocator() {}
+	template <class U>
+	Node_allocator(const Node_allocator<U>&) {}
+	T* allocate(std::size_t n)
+	{
+		if (n != 1) {
+			return std::allocator<T>().allocate(n);
+		}
+		Free_list& free = free_list();
+		if (free.head == nullptr) {
+			return reinterpret_cast<T*>(new Slot);
+		}
+		Slot* slot = free.head;
+		free.head = slot->next;
+		return reinterpret_cast<T*>(slot);
+	}
+	void deallocate(T* p, std::size_t n)
+	{
+		if (n != 1) {
+			std::allocator<T>().deallocate(p, n);
+			return;
+		}
+		Free_list& free = free_list();
+		Slot* slot = reinterpret_cast<Slot*>(p);
+		slot->next = free.head;
+		free.head = slot;
+	}
+	template <class U>
+	bool operator==(const Node_allocator<U>&) const {return true;}
+	template <class U>
+	bool operator!=(const Node_allocator<U>&) const {return false;}
+private:
+	union Slot
+	{
+		Slot* next;
+		alignas(T) unsigned char value[sizeof(T)];
+	};
+	struct Free_list
+	{
+		Slot* head = nullptr;
+		~Free_list()
+		{
+			while (head != nullptr) {
+				Slot* slot = head;
+				head = slot->next;
+				delete slot;
+			}
+		}
+	};
+	static Free_list& free_list()
+	{
+		thread_local Free_list free;
+		return free;
+	}
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // A helper class for the Trangulation_2 class.
 // This code is for internal use only and should not be used directly.
 // For this reason, this code is deliberately undocumented.
 ////////////////////////////////////////////////////////////////////////////////
 
-template <class Kernel>
+template <class Kernel, bool VertexCache>
 class Make_halfedge_data_structure
 {
 private:
@@ -65,6 +147,21 @@ private:
 	struct My_vertex : public CGAL::HalfedgeDS_vertex_base<Refs,
 	  CGAL::Tag_true, typename Traits::Point>
 	{
+		My_vertex() : id_(-1) {}
+		int id() const {return id_;}
+		void set_id(int id) {id_ = id;}
+	private:
+		int id_;
+	};
+	template <class Refs, class Traits>
+	struct My_cached_vertex : public My_vertex<Refs, Traits>
+	{
+		typedef typename Traits::Cached_point Cached_point;
+		My_cached_vertex() : cached_point_() {}
+		const Cached_point& cached_point() const {return cached_point_;}
+		void set_cached_point(const Cached_point& c) {cached_point_ = c;}
+	private:
+		Cached_point cached_point_;
 	};
 	template <class Refs>
 	struct My_face : public CGAL::HalfedgeDS_face_base<Refs>
@@ -111,17 +208,46 @@ private:
 	    };
 	    template <class Refs, class Traits>
 	    struct Vertex_wrapper {
-	        typedef My_vertex<Refs, Traits> Vertex;
+	        typedef std::conditional_t<VertexCache,
+	          My_cached_vertex<Refs, Traits>, My_vertex<Refs, Traits>> Vertex;
 	    };
 	};
 	struct My_traits
 	{
 	    typedef typename Kernel::Point_2  Point;
+	    typedef typename ra::geometry::Kernel<std::common_type_t<
+	      typename Kernel::FT, double>>::Cached_point Cached_point;
 	};
 public:
-	using type = CGAL::HalfedgeDS_default<My_traits, My_items>;
+	using type = CGAL::HalfedgeDS_default<My_traits, My_items,
+	  Node_allocator<int>>;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// A helper function for the Trangulation_2 class.
+// Get the position of the point (x, y) of a 2^16 by 2^16 grid along a
+// Hilbert curve through the grid.
+////////////////////////////////////////////////////////////////////////////////
+
+inline std::uint32_t hilbert_index(std::uint32_t x, std::uint32_t y)
+{
+	constexpr std::uint32_t n = std::uint32_t(1) << 16;
+	std::uint32_t d = 0;
+	for (std::uint32_t s = n / 2; s > 0; s /= 2) {
+		std::uint32_t rx = (x & s) ? 1 : 0;
+		std::uint32_t ry = (y & s) ? 1 : 0;
+		d += s * s * ((3 * rx) ^ ry);
+		if (ry == 0) {
+			if (rx == 1) {
+				x = n - 1 - x;
+				y = n - 1 - y;
+			}
+			std::swap(x, y);
+		}
+	}
+	return d;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // The Triangulation_2 class template.
 // A triangulation class based on a halfedge data structure.
@@ -129,11 +255,15 @@ public:
 
 /*
 Template parameters:
-K    The geometry kernel to be used by the triangulation
-     (e.g., CGAL::Cartesian<double>).
+K            The geometry kernel to be used by the triangulation
+             (e.g., CGAL::Simple_cartesian<double>, whose points are
+             stored in place in the vertices).
+VertexCache  Whether each vertex caches the values of the geometry kernel
+             that depend on its point alone (see vertex_cache).  Without
+             the cache (the default), the vertices have no space for it.
 */
 
-template <typename K>
+template <typename K, bool VertexCache = false>
 class Triangulation_2 {
 public:
 
@@ -141,18 +271,35 @@ public:
 	using Kernel = K;
 
 	// The halfedge data structure used by the class.
-	using HDS = typename Make_halfedge_data_structure<Kernel>::type;
+	using HDS = typename Make_halfedge_data_structure<Kernel, VertexCache>::type;
 
 	// The point (in 2-D) type.
 	// For the interface provided by Point, see:
 	// https://doc.cgal.org/latest/Kernel_23/classCGAL_1_1Point__2.html
 	// Items of interest: x, y, constructors.
+	// The coordinates are stored with the number type of the kernel.
+	// With a kernel of float (e.g., CGAL::Simple_cartesian<float>), the
+	// input coordinates are rounded to float, which halves the memory
+	// of the points; the geometric tests promote them to double exactly,
+	// so the results are those for the same values stored as double.
 	using Point = typename Kernel::Point_2;
 
+	// The vector (in 2-D) type.
+	using Vector = typename Kernel::Vector_2;
+
+	// The values of the geometry kernel (i.e., ra::geometry::Kernel) that
+	// depend on the point of a vertex alone, which each vertex caches
+	// when the vertex cache is enabled (see vertex_cache).
+	using Cached_point = typename ra::geometry::Kernel<
+	  std::common_type_t<typename Kernel::FT, double>>::Cached_point;
+
 	// The vertex type.
 	// For the interface provided by Vertex, see:
 	// https://doc.cgal.org/latest/Polyhedron/classCGAL_1_1Polyhedron__3_1_1Vertex.html
 	// Items of interest: point, halfedge.
+	// With the vertex cache, the vertices also provide cached_point, and
+	// their points must only be changed by set_point (since writing to
+	// point directly leaves the cached values stale).
 	using Vertex = typename HDS::Vertex;
 
 	// The mutating vertex handle type.
@@ -220,13 +367,21 @@ public:
 	The description of a triangulation is read from the input stream in
 	(in OFF format) and a triangulation is constructed corresponding to the
 	data read.
-	Upon failure, an exception is thrown.  The type of the thrown exception is
-	either std::exception or an type derived therefrom.
-	In cases of invalid input data (not I/O errors), std::abort might be
-	called.
+	Upon failure (including invalid input data), an exception is thrown.
+	The type of the thrown exception is either std::exception or an type
+	derived therefrom.
 	*/
 	Triangulation_2(std::istream& in);
 
+	/*
+	Construct an empty triangulation.
+	A triangulation can subsequently be read into it with input_off or
+	input_binary, which allows one triangulation object to be reused.
+	The vertices, halfedges and faces of the previous triangulation are
+	then recycled by the thread for the new one.
+	*/
+	Triangulation_2();
+
 	// The triangulation type is not movable.
 	Triangulation_2(Triangulation_2&&) = delete;
 	Triangulation_2& operator=(Triangulation_2&&) = delete;
@@ -322,6 +477,57 @@ public:
 	*/
 	Halfedge_handle flip_edge(Halfedge_handle h);
 
+	/*
+	Split a face by inserting a vertex.
+	A new vertex with the point p is added, and the face f is replaced by
+	the three faces formed by the new vertex and the edges of f.
+	Precondition:
+	The point p must lie strictly inside the face f.
+	Return value:
+	A halfedge whose target is the new vertex is returned.
+	*/
+	Halfedge_handle split_face(Face_handle f, const Point& p);
+
+	/*
+	Split an edge by inserting a vertex.
+	A new vertex with the point p is added on the edge associated with the
+	halfedge h, and each face incident on the edge is replaced by the two
+	faces formed by the new vertex and the other two edges of the face.
+	The edge may be a border edge.
+	Precondition:
+	The point p must lie strictly inside the edge.
+	Return value:
+	A halfedge whose target is the new vertex is returned.
+	*/
+	Halfedge_handle split_edge(Halfedge_handle h, const Point& p);
+
+	/*
+	Erase a vertex and its incident edges.
+	The faces incident on the vertex v are merged into a single polygonal
+	face bounded by the link of v or, if v is on the border, into the
+	border.  The triangulation is not valid again until the polygon (or
+	the part of the border that was exposed) is filled with add_edge.
+	The time taken is linear in the degree of v.
+	Return value:
+	A halfedge on the boundary of the merged face (or on the border) whose
+	target is one of the vertices that were adjacent to v is returned.
+	*/
+	Halfedge_handle erase_vertex(Vertex_handle v);
+
+	/*
+	Add an edge joining two vertices of a face.
+	The halfedges h and g must be distinct, nonconsecutive halfedges on the
+	boundary of the same face (or both on the border).  An edge from the
+	target of h to the target of g is added, and the part of the boundary
+	from h->next() to g, together with the new edge, becomes a new face.
+	The other part of the boundary remains associated with the original
+	face (or with the border).
+	Return value:
+	The new halfedge whose target is the target of g and that is on the
+	boundary of the original face (or on the border) is returned.
+	*/
+	Halfedge_handle add_edge(Halfedge_handle h, Halfedge_handle g);
+
 	/*
 	Read a triangulation from an input stream in OFF format.
 	A triangulation is read in OFF format from the input stream in.
@@ -330,9 +536,196 @@ public:
 	*/
 	bool input_off(std::istream& in);
 
+	/*
+	Read a triangulation from an input stream in binary format.
+	The binary format consists of the signature "BTRI", the number of
+	vertices and the number of faces (as 32-bit integers), the x and y
+	coordinates of each vertex (as doubles), and the three vertex indices
+	of each face (as 32-bit integers), all in native byte order.
+	Return value:
+	Upon success, true is returned; otherwise, false is returned.
+	*/
+	bool input_binary(std::istream& in);
+
+	/*
+	Build a triangulation from arrays.
+	The array coordinates holds the x and y coordinates of each of the
+	num_vertices vertices, and the array faces holds the three vertex
+	indices of each of the num_faces faces (in CCW order).  The arrays are
+	read in place (i.e., without being copied).
+	Return value:
+	Upon success, true is returned; otherwise, false is returned.
+	*/
+	bool input_arrays(const double* coordinates, int num_vertices,
+	  const std::int32_t* faces, int num_faces);
+
+	/*
+	The wall-clock times (in seconds) of the phases of an input operation:
+	reading the input (parse), building the halfedge data structure
+	(build), and checking the triangulation (validate).  These are the
+	phases to which the allocation profiler attributes allocations.
+	The parse time of input_arrays is zero.
+	*/
+	struct Input_times {
+		double parse_seconds;
+		double build_seconds;
+		double validate_seconds;
+	};
+
+	/*
+	Get the times of the phases of the last input operation.
+	*/
+	const Input_times& input_times() const
+	  {return input_times_;}
+
+	/*
+	Write the faces of a triangulation to an array.
+	The three vertex indices of each face (in CCW order) are written to the
+	array faces, which must hold 3 * size_of_faces() elements.  The vertex
+	indices are those of the output operations (e.g., the input indices of
+	the vertices, by default).
+	*/
+	void output_faces(std::int32_t* faces) const;
+
+	/*
+	Get the vertices of a triangulation in the order in which the output
+	operations write them (i.e., the index of a vertex in the output is its
+	position in the result).
+	*/
+	std::vector<Vertex_const_handle> output_vertices() const;
+
+	/*
+	Write a triangulation to an output stream in binary format.
+	The format is the one read by input_binary.
+	Return value:
+	Upon success, true is returned; otherwise, false is returned.
+	*/
+	bool output_binary(std::ostream& out) const;
+
+	/*
+	Apply a function to every edge of the triangulation using multiple
+	threads.
+	The edges are split into num_threads contiguous ranges of nearly equal
+	size, each of which is processed by its own thread.  The function f is
+	called as f(h, i), where h is one of the halfedges of an edge and i is
+	the index of the range (i.e., thread) to which the edge belongs.
+	Since the calls for different ranges are concurrent, f must not modify
+	the triangulation, and any state that it updates must be per range.
+	The first range is processed by the calling thread, and each other
+	range by a new thread, which first walks to the start of its range
+	from the nearer end of the halfedges (so the time taken is that of
+	the largest range plus a walk over at most half of the edges).  If
+	given, the function finish is called as
+	finish(i) by the thread of range i after its last call of f (e.g., to
+	collect the thread-local state of the thread).
+	*/
+	template <class Function>
+	void parallel_for_each_edge(Function f, int num_threads) const;
+	template <class Function, class Finish>
+	void parallel_for_each_edge(Function f, Finish finish,
+	  int num_threads) const;
+
+	/*
+	Set whether the input operations store the vertices and faces in
+	the order of a Hilbert curve through their locations (instead of
+	in the order in which they are read).
+	Storing nearby elements near each other in memory improves the
+	locality of traversals of the triangulation (e.g., the LOP) when the
+	input is not already spatially ordered.  This is disabled by default:
+	the gain depends on how CGAL's halfedge data structure lays out its
+	elements in memory, and it has not been measured with a CGAL build,
+	so it should be measured (e.g., with the --counters option of
+	delaunay_triangulation) before it is enabled.
+	*/
+	void set_spatial_sort(bool spatial_sort)
+	  {spatial_sort_ = spatial_sort;}
+
+	/*
+	Test if each vertex caches the values of the geometry kernel that
+	depend on its point alone (i.e., its lifted coordinate as a tight
+	interval and the magnitude of its coordinates), so that the LOP
+	passes the cached values to the tests of the kernel instead of
+	recomputing them for every test on the point.
+	The cache is chosen by the template parameter VertexCache, since it
+	adds the size of a Cached_point to every vertex.  The input
+	operations and set_point keep it up to date.
+	*/
+	static constexpr bool vertex_cache()
+	  {return VertexCache;}
+
+	/*
+	Move the vertex v to the point p (updating its cached values if the
+	vertex cache is enabled).  With the vertex cache, this is the only
+	way to change the point of a vertex.
+	The caller is responsible for the validity of the triangulation.
+	*/
+	void set_point(Vertex_handle v, const Point& p);
+
+	/*
+	Set whether the output operations write the vertices in the order in
+	which they were read (which is the default), or in the order in which
+	they are stored.  The two orders only differ if the spatial sort is
+	enabled.  Vertices added after the input are written last.
+	*/
+	void set_output_in_input_order(bool output_in_input_order)
+	  {output_in_input_order_ = output_in_input_order;}
+
+	/*
+	The levels of validation performed by the input operations.
+	full      Check the topology of the triangulation, the orientation of
+	          every face, and the convexity of the border.  The geometric
+	          checks use the filtered (i.e., robust) orientation test of
+	          ra::geometry::Kernel, and the faces are checked in parallel
+          (see set_num_threads).
+	topology  Only check the topology of the triangulation (i.e., that
+	          every edge has an incident face, every vertex has an incident
+	          edge, and there are no holes).
+	trusted   Only perform the checks needed to build the triangulation.
+	          This is intended for data written by this class (e.g., by
+	          output_binary), and the result is undefined for invalid data.
+	The levels are those of the library interface (trilib/lop.hpp), and
+	they are shared by all instances of this class template.
+	*/
+	using Validation = trilib::Validation;
+
+	/*
+	Set the level of validation performed by the input operations.
+	The default level is full.
+	The levels topology and trusted skip the geometric checks, so they
+	require that the faces are given in CCW order and that the border is
+	convex.  This is not detected otherwise: the LOP then runs on a mesh
+	that is not a triangulation, and its result is meaningless.
+	*/
+	void set_validation(Validation validation)
+	  {validation_ = validation;}
+
+	/*
+	Set the maximum number of threads that the input operations use to
+	check the orientation of the faces (at the validation level full).
+	The default is 1 (i.e., the calling thread alone).  A mesh is only
+	split across threads if each thread has many faces to check, and the
+	kernel statistics of the other threads are added to those of the
+	calling thread.
+	*/
+	void set_num_threads(int num_threads)
+	  {num_threads_ = std::max(1, num_threads);}
+
+	/*
+	Remove all vertices, faces, and halfedges from the triangulation.
+	*/
+	void clear()
+	  {hds_.clear();}
+
 	/*
 	Write a triangulation to an output stream in OFF format.
 	The triangulation is written in OFF format to the output stream out.
+	The coordinates are written with max_digits10 significant digits
+	(whatever the precision of out, which is restored afterwards), so
+	that reading the output back gives exactly the points that were
+	triangulated: at the default precision of 6 digits, a non-integer
+	coordinate would be rounded, and the mesh read back could violate the
+	preferred-directions Delaunay property that was computed for it.
+	Integer coordinates are written as at any precision.
 	Return value:
 	Upon success, true is returned; otherwise, false is returned.
 	*/
@@ -342,7 +735,25 @@ private:
 
 	class Builder;
 	friend class Builder;
+
+	bool build(const double* coordinates, int num_vertices,
+	  const std::int32_t* faces, int num_faces);
+	static double seconds_since(std::chrono::steady_clock::time_point start);
+	template <class T>
+	static bool read_block_array(std::istream& in, std::vector<T>& values,
+	  std::size_t n);
+	Vertex_handle new_vertex(const Point& p);
+	void update_vertex_cache(Vertex_handle v);
+	Halfedge_handle new_edge(Vertex_handle va, Vertex_handle vb);
+	void make_triangle(Face_handle f, Halfedge_handle ha, Halfedge_handle hb,
+	  Halfedge_handle hc);
+
 	HDS hds_;
+	bool spatial_sort_;
+	bool output_in_input_order_;
+	Validation validation_;
+	int num_threads_;
+	Input_times input_times_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -352,18 +763,20 @@ private:
 // For this reason, this code is deliberately undocumented.
 ////////////////////////////////////////////////////////////////////////////////
 
-template <typename Kernel>
-struct Triangulation_2<Kernel>::Builder
+template <typename Kernel, bool VertexCache>
+struct Triangulation_2<Kernel, VertexCache>::Builder
 {
 public:
-	using Triangulation = Triangulation_2<Kernel>;
+	using Triangulation = Triangulation_2<Kernel, VertexCache>;
 	using Point = Triangulation::Point;
+	using Geometry_kernel = ra::geometry::Kernel<
+	  std::common_type_t<typename Kernel::FT, double>>;
 	Builder();
 	~Builder();
 	Builder(const Builder&) = delete;
 	Builder& operator=(const Builder&) = delete;
-	void add_vertex(const Point& p);
-	void add_face(int va, int vb, int vc);
+	void add_vertex(const Point& p, int id);
+	bool add_face(int va, int vb, int vc);
 	bool apply(Triangulation& tri);
 
 private:
@@ -393,6 +806,8 @@ private:
 
 	Halfedge_handle lookup_halfedge(Vertex_handle va, Vertex_handle vb);
 
+	static constexpr int min_faces_per_thread = 1 << 14;
+
 	int num_vertices_;
 	Vertex_lut vertex_lut_;
 	Edge_lut edge_lut_;
@@ -402,33 +817,34 @@ private:
 
 };
 
-template <typename Kernel>
-Triangulation_2<Kernel>::Builder::Builder()
+template <typename Kernel, bool VertexCache>
+Triangulation_2<Kernel, VertexCache>::Builder::Builder()
 {
 	num_vertices_ = 0;
 }
 
-template <typename Kernel>
-Triangulation_2<Kernel>::Builder::~Builder()
+template <typename Kernel, bool VertexCache>
+Triangulation_2<Kernel, VertexCache>::Builder::~Builder()
 {
 }
 
-template <typename Kernel>
-void Triangulation_2<Kernel>::Builder::add_vertex(const Point& p)
+template <typename Kernel, bool VertexCache>
+void Triangulation_2<Kernel, VertexCache>::Builder::add_vertex(const Point& p, int id)
 {
 #if (TRIANGULATION_2_DEBUG_LEVEL >= 1)
 	std::cerr << "adding vertex " << num_vertices_ << " " << p << "\n";
 #endif
 	Vertex v;
 	v.point() = p;
+	v.set_id(id);
 	Vertex_handle vertex = hds_.vertices_push_back(v);
 	vertex->set_halfedge(nullptr);
 	vertex_lut_.insert(typename Vertex_lut::value_type(num_vertices_, vertex));
 	++num_vertices_;
 }
 
-template <typename Kernel>
-auto Triangulation_2<Kernel>::Builder::lookup_halfedge(Vertex_handle va,
+template <typename Kernel, bool VertexCache>
+auto Triangulation_2<Kernel, VertexCache>::Builder::lookup_halfedge(Vertex_handle va,
   Vertex_handle vb) -> Halfedge_handle
 {
 	Halfedge_handle result;
@@ -470,8 +886,11 @@ auto Triangulation_2<Kernel>::Builder::lookup_halfedge(Vertex_handle va,
 	return result;
 }
 
-template <typename Kernel>
-void Triangulation_2<Kernel>::Builder::add_face(int vai, int vbi, int vci)
+// Add a face, returning false if it repeats a vertex or if one of its
+// edges already has a face on the same side (i.e., if the face is a
+// duplicate or makes the triangulation non-manifold).
+template <typename Kernel, bool VertexCache>
+bool Triangulation_2<Kernel, VertexCache>::Builder::add_face(int vai, int vbi, int vci)
 {
 #if (TRIANGULATION_2_DEBUG_LEVEL >= 1)
 	std::cerr << "adding face " << vai << " " << vbi << " " << vci << "\n";
@@ -479,6 +898,10 @@ void Triangulation_2<Kernel>::Builder::add_face(int vai, int vbi, int vci)
 	assert(vai >= 0 && vai < num_vertices_);
 	assert(vbi >= 0 && vbi < num_vertices_);
 	assert(vci >= 0 && vci < num_vertices_);
+	if (vai == vbi || vbi == vci || vci == vai) {
+		std::cerr << "face with repeated vertex\n";
+		return false;
+	}
 	assert(vertex_lut_.find(vai) != vertex_lut_.end());
 	assert(vertex_lut_.find(vbi) != vertex_lut_.end());
 	assert(vertex_lut_.find(vci) != vertex_lut_.end());
@@ -491,9 +914,6 @@ void Triangulation_2<Kernel>::Builder::add_face(int vai, int vbi, int vci)
 #if (TRIANGULATION_2_DEBUG_LEVEL >= 1)
 	std::cerr << "    vertices " << va->point() << " " << vb->point() << " " << vc->point() << "\n";
 #endif
-	assert(CGAL::orientation(va->point(), vb->point(), vc->point()) ==
-	  CGAL::LEFT_TURN);
-
 	Halfedge_handle ab = lookup_halfedge(va, vb);
 	Halfedge_handle bc = lookup_halfedge(vb, vc);
 	Halfedge_handle ca = lookup_halfedge(vc, va);
@@ -527,26 +947,29 @@ void Triangulation_2<Kernel>::Builder::add_face(int vai, int vbi, int vci)
 		border_halfedges_.erase(border_halfedges_.find(bc));
 		border_halfedges_.erase(border_halfedges_.find(ca));
 	} else {
-		// ERROR
-		assert(false);
-		abort();
+		std::cerr << "duplicate face or non-manifold edge\n";
+		return false;
 	}
+	return true;
 }
 
-template <typename Kernel>
-bool Triangulation_2<Kernel>::Builder::apply(Triangulation_2& tri)
+template <typename Kernel, bool VertexCache>
+bool Triangulation_2<Kernel, VertexCache>::Builder::apply(Triangulation_2& tri)
 {
 #if (TRIANGULATION_2_DEBUG_LEVEL >= 1)
 	std::cerr << "apply\n";
 #endif
+	RA_ALLOC_SCOPE(ra::profile::Region::validate);
 	constexpr bool report_all = true;
 
 	Halfedge_handle border_halfedge = Halfedge_handle();
 
 	bool valid = true;
+	bool check_topology = (tri.validation_ != Validation::trusted);
+	bool check_geometry = (tri.validation_ == Validation::full);
 
 	// Check for any edge that has no incident faces.
-	if (valid) {
+	if (valid && check_topology) {
 		for (auto e = edge_lut_.begin(); e != edge_lut_.end(); ++e) {
 			if (e->second->is_border() &&
 			  e->second->opposite()->is_border()) {
@@ -560,7 +983,7 @@ bool Triangulation_2<Kernel>::Builder::apply(Triangulation_2& tri)
 	}
 
 	// Check for any vertex that has no incident edges.
-	if (valid) {
+	if (valid && check_topology) {
 		typename Vertex_lut::iterator cur;
 		typename Vertex_lut::iterator next;
 		cur = vertex_lut_.begin();
@@ -580,9 +1003,15 @@ bool Triangulation_2<Kernel>::Builder::apply(Triangulation_2& tri)
 		}
 	}
 
-	border_halfedge = *border_halfedges_.begin();
+	// A triangulation with no faces, or whose faces close up (e.g., a
+	// face and its reverse), has no border.
+	if (valid && border_halfedges_.empty()) {
+		std::cerr << "no border\n";
+		valid = false;
+	}
 
 	if (valid) {
+		border_halfedge = *border_halfedges_.begin();
 		Halfedge_handle cur_halfedge = border_halfedge;
 		Halfedge_handle next_halfedge;
 		do {
@@ -590,38 +1019,85 @@ bool Triangulation_2<Kernel>::Builder::apply(Triangulation_2& tri)
 			do {
 				h = h->opposite()->prev();
 			} while (!h->is_border_edge());
-			if (h == border_halfedge) {
-				// This should not happen.
-				assert(false);
-				abort();
+			auto cur_position = border_halfedges_.find(cur_halfedge);
+			if (h == border_halfedge ||
+			  cur_position == border_halfedges_.end()) {
+				// This cannot happen for a triangulation whose faces
+				// were all added.
+				std::cerr << "invalid border\n";
+				valid = false;
+				break;
 			}
 			next_halfedge = h->opposite();
 			next_halfedge->set_prev(cur_halfedge);
 			cur_halfedge->set_next(next_halfedge);
-			border_halfedges_.erase(border_halfedges_.find(cur_halfedge));
+			border_halfedges_.erase(cur_position);
 			cur_halfedge = next_halfedge;
 		} while (cur_halfedge != border_halfedge);
 		// Check for more than one bounding loop.
-		if (!border_halfedges_.empty()) {
+		if (valid && !border_halfedges_.empty()) {
 			std::cerr << "one or more holes are present\n";
 			valid = false;
 		}
 	}
 
 	// Check orientation of finite faces.
-	if (valid) {
-		CGAL::Orientation orient;
-		for (auto i = face_list_.begin(); i != face_list_.end(); ++i) {
-			Halfedge_handle halfedge = (*i)->halfedge();
-			if ((orient = CGAL::orientation(halfedge->vertex()->point(),
-			  halfedge->next()->vertex()->point(),
-			  halfedge->next()->next()->vertex()->point())) !=
-			  CGAL::LEFT_TURN) {
+	// The faces are split into contiguous ranges (at most the number of
+	// threads of the triangulation) that are checked in parallel, and the
+	// faces with incorrect orientation are reported in order afterwards.
+	// The range 0 is checked by the calling thread, and the kernel
+	// statistics of the other threads are added to its statistics.
+	if (valid && check_geometry) {
+		using Orientation = typename Geometry_kernel::Orientation;
+		using Statistics = typename Geometry_kernel::Statistics;
+		int num_faces = face_list_.size();
+		int num_ranges = std::max(1, std::min(tri.num_threads_,
+		  num_faces / min_faces_per_thread));
+		int faces_per_range = (num_faces + num_ranges - 1) / num_ranges;
+		std::vector<std::vector<int>> bad_faces(num_ranges);
+		std::vector<Statistics> stats(num_ranges,
+		  Geometry_kernel::make_stat());
+		auto check = [this, &bad_faces, &stats, faces_per_range,
+		  num_faces](int r) {
+			Geometry_kernel kernel;
+			int end = std::min(num_faces, (r + 1) * faces_per_range);
+			for (int i = r * faces_per_range; i < end; ++i) {
+				Halfedge_handle halfedge = face_list_[i]->halfedge();
+				if (kernel.orientation(halfedge->vertex()->point(),
+				  halfedge->next()->vertex()->point(),
+				  halfedge->next()->next()->vertex()->point()) !=
+				  Orientation::left_turn) {
+					bad_faces[r].push_back(i);
+				}
+			}
+			if (r != 0) {
+				// A new thread's statistics are those of its range alone.
+				Geometry_kernel::get_statistics(stats[r]);
+			}
+		};
+		std::vector<std::thread> threads;
+		for (int r = 1; r < num_ranges; ++r) {
+			threads.emplace_back(check, r);
+		}
+		check(0);
+		for (auto& t : threads) {
+			t.join();
+		}
+		for (int r = 1; r < num_ranges; ++r) {
+			Geometry_kernel::add_statistics(stats[r]);
+		}
+		Geometry_kernel kernel;
+		for (const auto& range : bad_faces) {
+			for (int i : range) {
+				Halfedge_handle halfedge = face_list_[i]->halfedge();
 				std::cerr << "face has incorrect orientation "
 				  << halfedge->vertex()->point() << " "
 				  << halfedge->next()->vertex()->point() << " "
 				  << halfedge->next()->next()->vertex()->point() << " "
-				  << orient << "\n";
+				  << static_cast<int>(kernel.orientation(
+				  halfedge->vertex()->point(),
+				  halfedge->next()->vertex()->point(),
+				  halfedge->next()->next()->vertex()->point())) << "\n";
 				valid = false;
 				if (!report_all) {
 					break;
@@ -631,12 +1107,14 @@ bool Triangulation_2<Kernel>::Builder::apply(Triangulation_2& tri)
 	}
 
 	// Check orientation of infinite face.
-	if (valid) {
+	if (valid && check_geometry) {
+		using Orientation = typename Geometry_kernel::Orientation;
+		Geometry_kernel kernel;
 		Halfedge_handle cur = border_halfedge;
 		do {
-			if (CGAL::orientation(cur->prev()->vertex()->point(),
+			if (kernel.orientation(cur->prev()->vertex()->point(),
 			  cur->vertex()->point(), cur->next()->vertex()->point()) ==
-			  CGAL::LEFT_TURN) {
+			  Orientation::left_turn) {
 				std::cerr << "border is not convex hull "
 				  << cur->prev()->vertex()->point()
 				  << " " << cur->vertex()->point()
@@ -661,8 +1139,10 @@ bool Triangulation_2<Kernel>::Builder::apply(Triangulation_2& tri)
 // Code for Triangulation_2 class.
 ////////////////////////////////////////////////////////////////////////////////
 
-template <typename Kernel>
-Triangulation_2<Kernel>::Triangulation_2(std::istream& in)
+template <typename Kernel, bool VertexCache>
+Triangulation_2<Kernel, VertexCache>::Triangulation_2(std::istream& in) :
+  spatial_sort_(false), output_in_input_order_(true),
+  validation_(Validation::full), num_threads_(1), input_times_{0, 0, 0}
 {
 	hds_.clear();
 	if (!input_off(in)) {
@@ -670,11 +1150,21 @@ Triangulation_2<Kernel>::Triangulation_2(std::istream& in)
 	}
 }
 
-template <typename Kernel>
-bool Triangulation_2<Kernel>::input_off(std::istream& in)
+template <typename Kernel, bool VertexCache>
+Triangulation_2<Kernel, VertexCache>::Triangulation_2() :
+  spatial_sort_(false), output_in_input_order_(true),
+  validation_(Validation::full), num_threads_(1), input_times_{0, 0, 0}
 {
 	hds_.clear();
-	Triangulation_2::Builder builder;
+}
+
+template <typename Kernel, bool VertexCache>
+bool Triangulation_2<Kernel, VertexCache>::input_off(std::istream& in)
+{
+	RA_ALLOC_SCOPE(ra::profile::Region::parse);
+	auto start = std::chrono::steady_clock::now();
+	input_times_ = Input_times{0, 0, 0};
+	hds_.clear();
 	std::string signature;
 	if (!(in >> signature) || signature != "OFF") {
 		std::cerr << "not OFF format\n";
@@ -687,9 +1177,9 @@ bool Triangulation_2<Kernel>::input_off(std::istream& in)
 		std::cerr << "cannot get number of vertices/faces/edges\n";
 		return false;
 	}
-	std::vector<Vertex_handle> v_lut;
+	std::vector<double> coords;
+	std::vector<std::int32_t> faces;
 	for (int i = 0; i < num_vertices; ++i) {
-		Vertex v;
 		double x;
 		double y;
 		double z;
@@ -697,10 +1187,9 @@ bool Triangulation_2<Kernel>::input_off(std::istream& in)
 			std::cerr << "cannot get vertex\n";
 			return false;
 		}
-		builder.add_vertex(Point(x, y));
+		coords.insert(coords.end(), {x, y});
 	}
 	for (int i = 0; i < num_faces; ++i) {
-		Face f;
 		int degree;
 		int vi[3];
 		if (!(in >> degree >> vi[0] >> vi[1] >> vi[2])) {
@@ -711,9 +1200,10 @@ bool Triangulation_2<Kernel>::input_off(std::istream& in)
 			std::cerr << "not a triangle\n";
 			return false;
 		}
-		builder.add_face(vi[0], vi[1], vi[2]);
+		faces.insert(faces.end(), {vi[0], vi[1], vi[2]});
 	}
-	if (!builder.apply(*this)) {
+	input_times_.parse_seconds = seconds_since(start);
+	if (!build(coords.data(), num_vertices, faces.data(), num_faces)) {
 		return false;
 	}
 #if (TRIANGULATION_2_DEBUG_LEVEL >= 1)
@@ -724,16 +1214,19 @@ bool Triangulation_2<Kernel>::input_off(std::istream& in)
 	return true;
 }
 
-template <typename Kernel>
-bool Triangulation_2<Kernel>::output_off(std::ostream& out) const
+template <typename Kernel, bool VertexCache>
+bool Triangulation_2<Kernel, VertexCache>::output_off(std::ostream& out) const
 {
+	RA_ALLOC_SCOPE(ra::profile::Region::output);
+	// Write enough digits for the coordinates to be read back exactly.
+	auto precision = out.precision(std::numeric_limits<double>::max_digits10);
 	out << "OFF\n";
 	out << hds_.size_of_vertices() << " " << hds_.size_of_faces() << " "
 	  << 0 << "\n";
 	std::map<Vertex_const_handle, int> vertex_lut;
 	int i = 0;
-	for (auto vi = hds_.vertices_begin(); vi != hds_.vertices_end(); ++vi) {
-		vertex_lut[&*vi] = i;
+	for (auto vi : output_vertices()) {
+		vertex_lut[vi] = i;
 		++i;
 		out << vi->point().x() << " " << vi->point().y() << " 0\n";
 	}
@@ -746,11 +1239,285 @@ bool Triangulation_2<Kernel>::output_off(std::ostream& out) const
 		int v2 = vertex_lut[h->vertex()];
 		out << "3 " << v0 << " " << v1 << " " << v2 << "\n";
 	}
+	out.precision(precision);
 	return bool(out);
 }
 
-template <typename Kernel>
-auto Triangulation_2<Kernel>::flip_edge(Halfedge_handle h) -> Halfedge_handle
+template <typename Kernel, bool VertexCache>
+template <class Function>
+void Triangulation_2<Kernel, VertexCache>::parallel_for_each_edge(Function f,
+  int num_threads) const
+{
+	parallel_for_each_edge(f, [](int) {}, num_threads);
+}
+
+template <typename Kernel, bool VertexCache>
+template <class Function, class Finish>
+void Triangulation_2<Kernel, VertexCache>::parallel_for_each_edge(Function f,
+  Finish finish, int num_threads) const
+{
+	if (size_of_edges() == 0) {
+		return;
+	}
+	num_threads = std::max(1, std::min(num_threads, size_of_edges()));
+	int num_edges = size_of_edges();
+	int edges_per_range = (num_edges + num_threads - 1) / num_threads;
+	int num_ranges = (num_edges + edges_per_range - 1) / edges_per_range;
+	// The halfedges are stored in a list, so the first halfedge of a range
+	// cannot be found in constant time.  Instead of a serial pass over the
+	// edges before the threads start, the thread of each range finds its
+	// first halfedge itself, walking from the nearer end of the list.
+	// Since a halfedge and its opposite are consecutive, each range
+	// starts on an even position.
+	auto process = [this, &f, &finish, num_edges, edges_per_range](int i) {
+		int first = i * edges_per_range;
+		int count = std::min(edges_per_range, num_edges - first);
+		bool from_begin = (first <= num_edges / 2);
+		Halfedge_const_iterator h = from_begin ?
+		  hds_.halfedges_begin() : hds_.halfedges_end();
+		if (from_begin) {
+			for (int j = 0; j < first; ++j) {
+				++++h;
+			}
+		} else {
+			for (int j = num_edges; j > first; --j) {
+				----h;
+			}
+		}
+		for (int j = 0; j < count; ++j, ++++h) {
+			f(Halfedge_const_handle(h), i);
+		}
+		finish(i);
+	};
+	std::vector<std::thread> threads;
+	for (int i = 1; i < num_ranges; ++i) {
+		threads.emplace_back(process, i);
+	}
+	process(0);
+	for (auto& t : threads) {
+		t.join();
+	}
+}
+
+// Get the vertices in the order in which they are to be written.
+template <typename Kernel, bool VertexCache>
+auto Triangulation_2<Kernel, VertexCache>::output_vertices() const
+  -> std::vector<Vertex_const_handle>
+{
+	std::vector<Vertex_const_handle> result;
+	result.reserve(hds_.size_of_vertices());
+	for (auto vi = hds_.vertices_begin(); vi != hds_.vertices_end(); ++vi) {
+		result.push_back(&*vi);
+	}
+	// Vertices without an input position (i.e., added later) go last.
+	auto key = [](Vertex_const_handle v) {
+		return (v->id() < 0) ? std::numeric_limits<int>::max() : v->id();
+	};
+	auto compare = [&key](Vertex_const_handle a, Vertex_const_handle b) {
+		return key(a) < key(b);
+	};
+	if (output_in_input_order_ &&
+	  !std::is_sorted(result.begin(), result.end(), compare)) {
+		std::stable_sort(result.begin(), result.end(), compare);
+	}
+	return result;
+}
+
+// Build the triangulation from the points and the vertex indices of the
+// faces (three per face), in the order of a Hilbert curve if the spatial
+// sort is enabled.
+template <typename Kernel, bool VertexCache>
+bool Triangulation_2<Kernel, VertexCache>::build(const double* coordinates,
+  int num_vertices, const std::int32_t* faces, int num_faces)
+{
+	RA_ALLOC_SCOPE(ra::profile::Region::build);
+	auto start = std::chrono::steady_clock::now();
+	if (num_vertices < 0 || num_faces < 0) {
+		std::cerr << "invalid number of vertices/faces\n";
+		return false;
+	}
+	for (std::size_t i = 0; i < 3 * std::size_t(num_faces); ++i) {
+		if (faces[i] < 0 || faces[i] >= num_vertices) {
+			std::cerr << "invalid vertex index\n";
+			return false;
+		}
+	}
+	auto point = [coordinates](int i) {
+		return Point(coordinates[2 * std::size_t(i)],
+		  coordinates[2 * std::size_t(i) + 1]);
+	};
+	Triangulation_2::Builder builder;
+	std::vector<int> vertex_order(num_vertices);
+	std::vector<int> face_order(num_faces);
+	std::iota(vertex_order.begin(), vertex_order.end(), 0);
+	std::iota(face_order.begin(), face_order.end(), 0);
+	if (spatial_sort_ && num_vertices > 0) {
+		double x_min = coordinates[0];
+		double x_max = x_min;
+		double y_min = coordinates[1];
+		double y_max = y_min;
+		for (int i = 0; i < num_vertices; ++i) {
+			x_min = std::min(x_min, coordinates[2 * std::size_t(i)]);
+			x_max = std::max(x_max, coordinates[2 * std::size_t(i)]);
+			y_min = std::min(y_min, coordinates[2 * std::size_t(i) + 1]);
+			y_max = std::max(y_max, coordinates[2 * std::size_t(i) + 1]);
+		}
+		double x_scale = (x_max > x_min) ? 65535.0 / (x_max - x_min) : 0.0;
+		double y_scale = (y_max > y_min) ? 65535.0 / (y_max - y_min) : 0.0;
+		auto key = [&](double x, double y) {
+			return hilbert_index(std::uint32_t((x - x_min) * x_scale),
+			  std::uint32_t((y - y_min) * y_scale));
+		};
+		std::vector<std::uint32_t> vertex_keys(num_vertices);
+		for (int i = 0; i < num_vertices; ++i) {
+			vertex_keys[i] = key(coordinates[2 * std::size_t(i)],
+			  coordinates[2 * std::size_t(i) + 1]);
+		}
+		std::vector<std::uint32_t> face_keys(num_faces);
+		for (int i = 0; i < num_faces; ++i) {
+			Point a = point(faces[3 * std::size_t(i)]);
+			Point b = point(faces[3 * std::size_t(i) + 1]);
+			Point c = point(faces[3 * std::size_t(i) + 2]);
+			face_keys[i] = key((a.x() + b.x() + c.x()) / 3.0,
+			  (a.y() + b.y() + c.y()) / 3.0);
+		}
+		std::stable_sort(vertex_order.begin(), vertex_order.end(),
+		  [&vertex_keys](int i, int j) {
+		  return vertex_keys[i] < vertex_keys[j];});
+		std::stable_sort(face_order.begin(), face_order.end(),
+		  [&face_keys](int i, int j) {return face_keys[i] < face_keys[j];});
+	}
+	std::vector<int> new_index(num_vertices);
+	for (int i = 0; i < num_vertices; ++i) {
+		new_index[vertex_order[i]] = i;
+		builder.add_vertex(point(vertex_order[i]), vertex_order[i]);
+	}
+	for (int i : face_order) {
+		std::size_t j = 3 * std::size_t(i);
+		if (!builder.add_face(new_index[faces[j]], new_index[faces[j + 1]],
+		  new_index[faces[j + 2]])) {
+			return false;
+		}
+	}
+	input_times_.build_seconds = seconds_since(start);
+	start = std::chrono::steady_clock::now();
+	bool valid = builder.apply(*this);
+	input_times_.validate_seconds = seconds_since(start);
+	if (valid && VertexCache) {
+		start = std::chrono::steady_clock::now();
+		for (auto v = vertices_begin(); v != vertices_end(); ++v) {
+			update_vertex_cache(v);
+		}
+		input_times_.build_seconds += seconds_since(start);
+	}
+	return valid;
+}
+
+template <typename Kernel, bool VertexCache>
+bool Triangulation_2<Kernel, VertexCache>::input_binary(std::istream& in)
+{
+	RA_ALLOC_SCOPE(ra::profile::Region::parse);
+	auto start = std::chrono::steady_clock::now();
+	input_times_ = Input_times{0, 0, 0};
+	hds_.clear();
+	char signature[4];
+	if (!in.read(signature, 4) || std::string(signature, 4) != "BTRI") {
+		std::cerr << "not binary triangulation format\n";
+		return false;
+	}
+	std::int32_t counts[2];
+	if (!in.read(reinterpret_cast<char*>(counts), sizeof(counts)) ||
+	  counts[0] < 0 || counts[1] < 0) {
+		std::cerr << "cannot get number of vertices/faces\n";
+		return false;
+	}
+	int num_vertices = counts[0];
+	int num_faces = counts[1];
+	// The counts are not trusted to size the arrays: they are read in
+	// blocks, so that the storage allocated is bounded by the data present.
+	std::vector<double> coords;
+	if (!read_block_array(in, coords, 2 * std::size_t(num_vertices))) {
+		std::cerr << "cannot get vertex\n";
+		return false;
+	}
+	std::vector<std::int32_t> indices;
+	if (!read_block_array(in, indices, 3 * std::size_t(num_faces))) {
+		std::cerr << "cannot get face\n";
+		return false;
+	}
+	input_times_.parse_seconds = seconds_since(start);
+	return build(coords.data(), num_vertices, indices.data(), num_faces);
+}
+
+template <typename Kernel, bool VertexCache>
+bool Triangulation_2<Kernel, VertexCache>::input_arrays(const double* coordinates,
+  int num_vertices, const std::int32_t* faces, int num_faces)
+{
+	input_times_ = Input_times{0, 0, 0};
+	hds_.clear();
+	return build(coordinates, num_vertices, faces, num_faces);
+}
+
+template <typename Kernel, bool VertexCache>
+void Triangulation_2<Kernel, VertexCache>::output_faces(std::int32_t* faces) const
+{
+	RA_ALLOC_SCOPE(ra::profile::Region::output);
+	// If the vertices are written in input order and every vertex has an
+	// input index, the index of a vertex in the output is its input index.
+	int num_vertices = hds_.size_of_vertices();
+	bool by_id = output_in_input_order_;
+	for (auto vi = hds_.vertices_begin(); by_id && vi != hds_.vertices_end();
+	  ++vi) {
+		by_id = (vi->id() >= 0 && vi->id() < num_vertices);
+	}
+	std::map<Vertex_const_handle, std::int32_t> vertex_lut;
+	if (!by_id) {
+		std::int32_t i = 0;
+		for (auto vi : output_vertices()) {
+			vertex_lut[vi] = i;
+			++i;
+		}
+	}
+	std::size_t k = 0;
+	for (auto fi = hds_.faces_begin(); fi != hds_.faces_end(); ++fi) {
+		Halfedge_const_handle h = fi->halfedge();
+		for (int j = 0; j < 3; ++j) {
+			faces[k++] = by_id ? h->vertex()->id() : vertex_lut[h->vertex()];
+			h = h->next();
+		}
+	}
+}
+
+template <typename Kernel, bool VertexCache>
+bool Triangulation_2<Kernel, VertexCache>::output_binary(std::ostream& out) const
+{
+	RA_ALLOC_SCOPE(ra::profile::Region::output);
+	std::int32_t counts[2] = {std::int32_t(hds_.size_of_vertices()),
+	  std::int32_t(hds_.size_of_faces())};
+	out.write("BTRI", 4);
+	out.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+	std::map<Vertex_const_handle, std::int32_t> vertex_lut;
+	std::int32_t i = 0;
+	for (auto vi : output_vertices()) {
+		vertex_lut[vi] = i;
+		++i;
+		double coords[2] = {double(vi->point().x()), double(vi->point().y())};
+		out.write(reinterpret_cast<const char*>(coords), sizeof(coords));
+	}
+	for (auto fi = hds_.faces_begin(); fi != hds_.faces_end(); ++fi) {
+		Halfedge_const_handle h = fi->halfedge();
+		std::int32_t v[3];
+		for (int j = 0; j < 3; ++j) {
+			v[j] = vertex_lut[h->vertex()];
+			h = h->next();
+		}
+		out.write(reinterpret_cast<const char*>(v), sizeof(v));
+	}
+	return bool(out);
+}
+
+template <typename Kernel, bool VertexCache>
+auto Triangulation_2<Kernel, VertexCache>::flip_edge(Halfedge_handle h) -> Halfedge_handle
 {
 	CGAL::HalfedgeDS_items_decorator<HDS> decorator;
 	//std::cerr << "flipping edge\n";
@@ -759,6 +1526,250 @@ auto Triangulation_2<Kernel>::flip_edge(Halfedge_handle h) -> Halfedge_handle
 	return result;
 }
 
+template <typename Kernel, bool VertexCache>
+double Triangulation_2<Kernel, VertexCache>::seconds_since(
+  std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(
+	  std::chrono::steady_clock::now() - start).count();
+}
+
+// Read n values in native byte order, a block at a time.
+template <typename Kernel, bool VertexCache>
+template <class T>
+bool Triangulation_2<Kernel, VertexCache>::read_block_array(std::istream& in,
+  std::vector<T>& values, std::size_t n)
+{
+	constexpr std::size_t block_size = std::size_t(1) << 16;
+	values.clear();
+	while (values.size() < n) {
+		std::size_t offset = values.size();
+		values.resize(offset + std::min(block_size, n - offset));
+		if (!in.read(reinterpret_cast<char*>(values.data() + offset),
+		  (values.size() - offset) * sizeof(T))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename Kernel, bool VertexCache>
+auto Triangulation_2<Kernel, VertexCache>::new_vertex(const Point& p) -> Vertex_handle
+{
+	Vertex v;
+	v.point() = p;
+	Vertex_handle vertex = hds_.vertices_push_back(v);
+	vertex->set_halfedge(nullptr);
+	update_vertex_cache(vertex);
+	return vertex;
+}
+
+// Compute the cached values of the vertex v (if the vertex cache is
+// enabled; otherwise, do nothing).
+template <typename Kernel, bool VertexCache>
+void Triangulation_2<Kernel, VertexCache>::update_vertex_cache(Vertex_handle v)
+{
+	if constexpr (VertexCache) {
+		using Geometry_kernel = ra::geometry::Kernel<
+		  std::common_type_t<typename Kernel::FT, double>>;
+		v->set_cached_point(Geometry_kernel::make_cached_point(v->point()));
+	}
+}
+
+template <typename Kernel, bool VertexCache>
+void Triangulation_2<Kernel, VertexCache>::set_point(Vertex_handle v, const Point& p)
+{
+	v->point() = p;
+	update_vertex_cache(v);
+}
+
+// Create a new edge from va to vb, and return its halfedge whose target
+// is vb.  The faces and the next/prev links are left for the caller.
+template <typename Kernel, bool VertexCache>
+auto Triangulation_2<Kernel, VertexCache>::new_edge(Vertex_handle va, Vertex_handle vb)
+  -> Halfedge_handle
+{
+	Halfedge_handle h = hds_.edges_push_back(Halfedge(), Halfedge());
+	h->set_vertex(vb);
+	h->opposite()->set_vertex(va);
+	return h;
+}
+
+// Link the halfedges ha, hb, and hc into a loop associated with the face f
+// (which is null for the border).
+template <typename Kernel, bool VertexCache>
+void Triangulation_2<Kernel, VertexCache>::make_triangle(Face_handle f, Halfedge_handle ha,
+  Halfedge_handle hb, Halfedge_handle hc)
+{
+	ha->set_next(hb);
+	hb->set_prev(ha);
+	hb->set_next(hc);
+	hc->set_prev(hb);
+	hc->set_next(ha);
+	ha->set_prev(hc);
+	ha->set_face(f);
+	hb->set_face(f);
+	hc->set_face(f);
+	if (f != Face_handle()) {
+		f->set_halfedge(ha);
+	}
+}
+
+template <typename Kernel, bool VertexCache>
+auto Triangulation_2<Kernel, VertexCache>::split_face(Face_handle f, const Point& p)
+  -> Halfedge_handle
+{
+	Halfedge_handle h[3];
+	h[0] = f->halfedge();
+	h[1] = h[0]->next();
+	h[2] = h[1]->next();
+	Vertex_handle c = new_vertex(p);
+	// The edge spoke[i] goes from the target of h[i] to c.
+	Halfedge_handle spoke[3];
+	for (int i = 0; i < 3; ++i) {
+		spoke[i] = new_edge(h[i]->vertex(), c);
+	}
+	Face_handle faces[3] = {f, hds_.faces_push_back(Face()),
+	  hds_.faces_push_back(Face())};
+	for (int i = 0; i < 3; ++i) {
+		make_triangle(faces[i], h[i], spoke[i],
+		  spoke[(i + 2) % 3]->opposite());
+	}
+	c->set_halfedge(spoke[0]);
+	return spoke[0];
+}
+
+template <typename Kernel, bool VertexCache>
+auto Triangulation_2<Kernel, VertexCache>::split_edge(Halfedge_handle h, const Point& p)
+  -> Halfedge_handle
+{
+	Halfedge_handle g = h->opposite();
+	Halfedge_handle hn = h->next();
+	Halfedge_handle hp = h->prev();
+	Halfedge_handle gn = g->next();
+	Halfedge_handle gp = g->prev();
+	Vertex_handle t = h->vertex();
+	Vertex_handle c = new_vertex(p);
+	// The halfedge h now ends at c, and k continues from c to t.
+	Halfedge_handle k = new_edge(c, t);
+	h->set_vertex(c);
+	if (t->halfedge() == h) {
+		t->set_halfedge(k);
+	}
+	c->set_halfedge(h);
+	if (h->is_border()) {
+		h->set_next(k);
+		k->set_prev(h);
+		k->set_next(hn);
+		hn->set_prev(k);
+		k->set_face(Face_handle());
+	} else {
+		Halfedge_handle m = new_edge(c, hn->vertex());
+		make_triangle(h->face(), h, m, hp);
+		make_triangle(hds_.faces_push_back(Face()), k, hn, m->opposite());
+	}
+	if (g->is_border()) {
+		gp->set_next(k->opposite());
+		k->opposite()->set_prev(gp);
+		k->opposite()->set_next(g);
+		g->set_prev(k->opposite());
+		k->opposite()->set_face(Face_handle());
+	} else {
+		Halfedge_handle n = new_edge(c, gn->vertex());
+		make_triangle(g->face(), g, gn, n->opposite());
+		make_triangle(hds_.faces_push_back(Face()), k->opposite(), n, gp);
+	}
+	return h;
+}
+
+template <typename Kernel, bool VertexCache>
+auto Triangulation_2<Kernel, VertexCache>::erase_vertex(Vertex_handle v) -> Halfedge_handle
+{
+	// Find the halfedges entering v, and the halfedges that will precede
+	// and follow them on the boundary of the merged face.
+	std::vector<Halfedge_handle> incoming;
+	Halfedge_handle h = v->halfedge();
+	do {
+		incoming.push_back(h);
+		h = h->next()->opposite();
+	} while (h != v->halfedge());
+	Face_handle merged = Face_handle();
+	for (auto i : incoming) {
+		if (i->is_border() || i->opposite()->is_border()) {
+			merged = Face_handle();
+			break;
+		}
+		merged = i->face();
+	}
+	std::vector<Halfedge_handle> before;
+	std::vector<Halfedge_handle> after;
+	for (auto i : incoming) {
+		before.push_back(i->prev());
+		after.push_back(i->opposite()->next());
+	}
+	for (auto i : incoming) {
+		Face_handle f = i->face();
+		if (f != Face_handle() && f != merged) {
+			hds_.faces_erase(f);
+		}
+	}
+	for (std::size_t i = 0; i < incoming.size(); ++i) {
+		Vertex_handle u = incoming[i]->opposite()->vertex();
+		if (u->halfedge() == incoming[i]->opposite()) {
+			u->set_halfedge(before[i]);
+		}
+		before[i]->set_next(after[i]);
+		after[i]->set_prev(before[i]);
+	}
+	for (auto i : incoming) {
+		hds_.edges_erase(i);
+	}
+	hds_.vertices_erase(v);
+	// The only halfedges of the merged face (or of the border) that were
+	// not already on it are those of the link of v, which precede the
+	// halfedges that entered v, so the cost is in the degree of v (and not
+	// in the length of the border).
+	for (auto i : before) {
+		i->set_face(merged);
+	}
+	Halfedge_handle result = before[0];
+	if (merged != Face_handle()) {
+		merged->set_halfedge(result);
+	}
+	return result;
+}
+
+template <typename Kernel, bool VertexCache>
+auto Triangulation_2<Kernel, VertexCache>::add_edge(Halfedge_handle h, Halfedge_handle g)
+  -> Halfedge_handle
+{
+	Face_handle f = h->face();
+	Halfedge_handle hn = h->next();
+	Halfedge_handle gn = g->next();
+	Halfedge_handle e = new_edge(g->vertex(), h->vertex());
+	Face_handle cut = hds_.faces_push_back(Face());
+	g->set_next(e);
+	e->set_prev(g);
+	e->set_next(hn);
+	hn->set_prev(e);
+	Halfedge_handle i = e;
+	do {
+		i->set_face(cut);
+		i = i->next();
+	} while (i != e);
+	cut->set_halfedge(e);
+	Halfedge_handle r = e->opposite();
+	h->set_next(r);
+	r->set_prev(h);
+	r->set_next(gn);
+	gn->set_prev(r);
+	r->set_face(f);
+	if (f != Face_handle()) {
+		f->set_halfedge(r);
+	}
+	return r;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
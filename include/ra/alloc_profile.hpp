@@ -0,0 +1,136 @@
+#ifndef ALLOC_PROFILE_HPP
+#define ALLOC_PROFILE_HPP
+#include <cstddef>
+#include <ostream>
+
+// An opt-in profiler of heap allocations.
+// If RA_ALLOC_PROFILE is nonzero, the replaceable global operator new and
+// operator delete (defined in app/alloc_profile.cpp, which must then be
+// linked into the program, and including the aligned forms) count each
+// allocation and its size, and each deallocation, in thread-local
+// counters. An allocation is attributed to the innermost region entered
+// with RA_ALLOC_SCOPE on the allocating thread, and its deallocation to
+// the same region (which is recorded with the allocation), but in the
+// counters of the deallocating thread.
+// If RA_ALLOC_PROFILE is zero (the default), RA_ALLOC_SCOPE expands to
+// nothing and the statistics are always zero.
+#ifndef RA_ALLOC_PROFILE
+#define RA_ALLOC_PROFILE 0
+#endif
+
+namespace ra::profile {
+
+	// Whether the profiler is compiled in.
+	constexpr bool enabled = (RA_ALLOC_PROFILE != 0);
+
+	// The regions to which allocations are attributed.
+	enum class Region {
+		// Outside of every other region.
+		other,
+		// Reading an input triangulation.
+		parse,
+		// Building the halfedge data structure of a triangulation.
+		build,
+		// Checking an input triangulation.
+		validate,
+		// Collecting the initial suspect edges of the LOP.
+		scan,
+		// Flipping the suspect edges of the LOP.
+		flip,
+		// Writing a triangulation.
+		output,
+		// The exact path of each predicate of the kernel.
+		orientation_exact,
+		side_of_oriented_circle_exact,
+		preferred_direction_exact,
+		locally_pd_delaunay_edge_exact,
+		flippable_quad_exact,
+	};
+
+	// The number of regions.
+	constexpr std::size_t region_count = 12;
+
+	// Returns the name of a region.
+	inline const char* region_name(Region region){
+		static const char* const names[region_count] = {"other", "parse", "build", "validate", "scan", "flip", "output",
+		  "orientation_exact", "side_of_oriented_circle_exact", "preferred_direction_exact",
+		  "locally_pd_delaunay_edge_exact", "flippable_quad_exact"};
+		return names[static_cast<std::size_t>(region)];
+	}
+
+	// The allocations attributed to one region.
+	struct Allocation_counts {
+		// The number of allocations.
+		std::size_t allocation_count;
+		// The total size of the allocations, in bytes.
+		std::size_t allocation_bytes;
+		// The number of deallocations.
+		std::size_t deallocation_count;
+	};
+
+	// The allocations of a thread, by region.
+	struct Allocation_statistics {
+		Allocation_counts regions[region_count];
+	};
+
+#if RA_ALLOC_PROFILE
+	namespace detail {
+		// The counters are plain (constant-initialized) thread-local
+		// objects, so they may be used by operator new on any thread at
+		// any time without themselves allocating.
+		inline thread_local Region current_region = Region::other;
+		inline thread_local Allocation_statistics statistics = {};
+	}
+
+	// Counts an allocation of size bytes in the current region, and
+	// returns the region (to be passed to record_deallocation).
+	inline Region record_allocation(std::size_t size){
+		Allocation_counts& counts = detail::statistics.regions[static_cast<std::size_t>(detail::current_region)];
+		++(counts.allocation_count);
+		counts.allocation_bytes += size;
+		return detail::current_region;
+	}
+
+	// Counts a deallocation in the region of its allocation.
+	inline void record_deallocation(Region region){
+		++(detail::statistics.regions[static_cast<std::size_t>(region)].deallocation_count);
+	}
+
+	// Attributes the allocations of the calling thread to a region for
+	// the lifetime of the object.
+	class Scope {
+		public:
+			explicit Scope(Region region) : saved_(detail::current_region) { detail::current_region = region; }
+			~Scope(){ detail::current_region = saved_; }
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+		private:
+			Region saved_;
+	};
+
+	inline void clear_statistics(){ detail::statistics = {}; }
+	inline void get_statistics(Allocation_statistics& statistics){ statistics = detail::statistics; }
+
+#define RA_ALLOC_SCOPE_CONCAT_(a, b) a##b
+#define RA_ALLOC_SCOPE_NAME_(line) RA_ALLOC_SCOPE_CONCAT_(ra_alloc_scope_, line)
+#define RA_ALLOC_SCOPE(region) ::ra::profile::Scope RA_ALLOC_SCOPE_NAME_(__LINE__)(region)
+#else
+	inline void clear_statistics(){}
+	inline void get_statistics(Allocation_statistics& statistics){ statistics = {}; }
+
+#define RA_ALLOC_SCOPE(region) static_cast<void>(0)
+#endif
+
+	// Writes the counts of the regions with any allocations or
+	// deallocations, one region per line.
+	inline void print_statistics(std::ostream& out, const Allocation_statistics& statistics){
+		for(std::size_t i = 0; i < region_count; ++i){
+			const Allocation_counts& counts = statistics.regions[i];
+			if( (counts.allocation_count == 0) && (counts.deallocation_count == 0) ){ continue; }
+			out<<"alloc "<<region_name(static_cast<Region>(i))<<" count="<<counts.allocation_count
+			  <<" bytes="<<counts.allocation_bytes<<" frees="<<counts.deallocation_count<<"\n";
+		}
+	}
+
+}
+#endif
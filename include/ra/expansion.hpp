@@ -0,0 +1,419 @@
+#ifndef EXPANSION_HPP
+#define EXPANSION_HPP
+#include<cfenv>
+#include<algorithm>
+#include<cstddef>
+#include<memory>
+#include<vector>
+#include"ra/interval.hpp"
+namespace ra::math {
+
+	// A bump allocator for the components of expansions.
+	// Storage is allocated in blocks that are kept when the arena is
+	// released, so that, once the first block is large enough, evaluating
+	// an expression performs no heap allocations.
+	class expansion_arena {
+		public:
+			// The default number of components preallocated by an arena.
+			// A scope that needs more (see expansion_bound) reserves it when
+			// it starts, and an allocation that does not fit adds a block;
+			// either way, the arena keeps the block for later scopes.
+			static constexpr std::size_t default_capacity = std::size_t(1) << 15;
+
+			// A position in the arena to which it can be released.
+			struct mark_type {
+				std::size_t block;
+				std::size_t offset;
+			};
+
+			explicit expansion_arena(std::size_t capacity = default_capacity) : block_(0), offset_(0), heap_allocation_count_(0) {
+				blocks_.reserve(16);
+				add_block(capacity);
+			}
+			expansion_arena(expansion_arena&&) = delete;
+			expansion_arena(const expansion_arena&) = delete;
+			expansion_arena& operator=(expansion_arena&&) = delete;
+			expansion_arena& operator=(const expansion_arena&) = delete;
+
+			// Get the arena of the calling thread.
+			static expansion_arena& local() {
+				thread_local expansion_arena arena;
+				return arena;
+			}
+
+			// Make the next n components allocated come from a single block,
+			// adding a block if no block is large enough.
+			void reserve(std::size_t n) {
+				while( (offset_ + n) > blocks_[block_].size ){
+					++block_;
+					offset_ = 0;
+					if(block_ == blocks_.size()){
+						add_block(std::max(n, 2*blocks_[block_-1].size));
+					}
+				}
+			}
+
+			// Allocate storage for n components.
+			double* allocate(std::size_t n) {
+				reserve(n);
+				double* result = blocks_[block_].data.get() + offset_;
+				offset_ += n;
+				return result;
+			}
+
+			// Give back the unused tail of the most recent allocation, of n
+			// components at p, keeping only the first used components.
+			void trim(double* p, std::size_t n, std::size_t used) {
+				if( (p + n) == (blocks_[block_].data.get() + offset_) ){
+					offset_ -= (n - used);
+				}
+			}
+
+			mark_type mark() const { return mark_type{block_, offset_}; }
+
+			// Release all storage allocated since the mark m was taken.
+			void release(const mark_type& m) {
+				block_ = m.block;
+				offset_ = m.offset;
+			}
+
+			// Get the number of heap allocations made by the arena.
+			unsigned long heap_allocation_count() const { return heap_allocation_count_; }
+
+		private:
+			struct block_type {
+				std::unique_ptr<double[]> data;
+				std::size_t size;
+			};
+
+			void add_block(std::size_t size) {
+				blocks_.push_back(block_type{std::unique_ptr<double[]>(new double[size]), size});
+				++heap_allocation_count_;
+			}
+
+			std::vector<block_type> blocks_;
+			std::size_t block_;
+			std::size_t offset_;
+			unsigned long heap_allocation_count_;
+	};
+
+	// Evaluates expansions in the arena of the calling thread.
+	// Upon destruction, all components allocated during the lifetime of
+	// the scope are released. Since expansion arithmetic requires
+	// round-to-nearest, the rounding mode is set for the lifetime of the
+	// scope and restored afterwards.
+	// If the scope is given a capacity, that many components are reserved
+	// in the arena when it starts, so that an evaluation using no more than
+	// that (e.g., as computed with expansion_bound) makes no heap allocation
+	// once the arena has grown to it.
+	class expansion_scope {
+		public:
+			explicit expansion_scope(std::size_t capacity = 0) : arena_(reserved_arena(capacity)), mark_(arena_.mark()), start_count_(arena_.heap_allocation_count()) {
+				std::fesetround(FE_TONEAREST);
+			}
+			~expansion_scope() {
+				arena_.release(mark_);
+			}
+			expansion_scope(expansion_scope&&) = delete;
+			expansion_scope(const expansion_scope&) = delete;
+			expansion_scope& operator=(expansion_scope&&) = delete;
+			expansion_scope& operator=(const expansion_scope&) = delete;
+
+			// Get the number of heap allocations made during the scope.
+			unsigned long heap_allocation_count() const { return arena_.heap_allocation_count() - start_count_; }
+
+		private:
+			static expansion_arena& reserved_arena(std::size_t capacity) {
+				expansion_arena& arena = expansion_arena::local();
+				arena.reserve(capacity);
+				return arena;
+			}
+
+			rounding_mode_saver rms_;
+			expansion_arena& arena_;
+			expansion_arena::mark_type mark_;
+			unsigned long start_count_;
+	};
+
+	// An exact number represented as a nonoverlapping floating-point
+	// expansion (i.e., an unevaluated sum of doubles ordered by increasing
+	// magnitude) in the arena of the calling thread.
+	// Arithmetic is exact provided that no intermediate value overflows
+	// or underflows, and it must be performed within an expansion_scope.
+	// An expansion is only valid until its scope ends.
+	class expansion {
+		public:
+			expansion(double value = 0.0) : components_(expansion_arena::local().allocate(1)), size_(1) {
+				components_[0] = value;
+			}
+
+			std::size_t size() const { return size_; }
+			const double* components() const { return components_; }
+
+			// Get an approximation of the value.
+			double estimate() const {
+				double result = 0.0;
+				for(std::size_t i = 0; i < size_; ++i){ result += components_[i]; }
+				return result;
+			}
+
+			// Get the sign of the value. Since zero components are
+			// eliminated, the largest component determines the sign.
+			int sign() const {
+				double largest = components_[size_-1];
+				return (largest > 0.0) - (largest < 0.0);
+			}
+
+			static expansion add(const expansion& obj_A, const expansion& obj_B){
+				expansion result(obj_A.size_ + obj_B.size_, nullptr);
+				result.size_ = sum_zeroelim(obj_A.size_, obj_A.components_, obj_B.size_, obj_B.components_, result.components_);
+				expansion_arena::local().trim(result.components_, obj_A.size_ + obj_B.size_, result.size_);
+				return result;
+			}
+
+			static expansion negate(const expansion& obj){
+				expansion result(obj.size_, nullptr);
+				for(std::size_t i = 0; i < obj.size_; ++i){ result.components_[i] = -(obj.components_[i]); }
+				result.size_ = obj.size_;
+				return result;
+			}
+
+			static expansion multiply(const expansion& obj_A, const expansion& obj_B){
+				if(obj_A.size_ < obj_B.size_){ return multiply(obj_B, obj_A); }
+				expansion_arena& arena = expansion_arena::local();
+				double* partial = arena.allocate(2*obj_A.size_);
+				expansion result(2*obj_A.size_, nullptr);
+				result.size_ = scale_zeroelim(obj_A.size_, obj_A.components_, obj_B.components_[0], result.components_);
+				arena.trim(result.components_, 2*obj_A.size_, result.size_);
+				for(std::size_t i = 1; i < obj_B.size_; ++i){
+					std::size_t partial_size = scale_zeroelim(obj_A.size_, obj_A.components_, obj_B.components_[i], partial);
+					expansion sum(result.size_ + partial_size, nullptr);
+					sum.size_ = sum_zeroelim(result.size_, result.components_, partial_size, partial, sum.components_);
+					arena.trim(sum.components_, result.size_ + partial_size, sum.size_);
+					result = sum;
+				}
+				return result;
+			}
+
+		private:
+			// Construct an expansion with uninitialized storage for n components.
+			expansion(std::size_t n, std::nullptr_t) : components_(expansion_arena::local().allocate(n)), size_(0) {}
+
+			static void two_sum(double a, double b, double& x, double& y){
+				x = a + b;
+				double b_virtual = x - a;
+				double a_virtual = x - b_virtual;
+				y = (a - a_virtual) + (b - b_virtual);
+			}
+
+			static void fast_two_sum(double a, double b, double& x, double& y){
+				x = a + b;
+				y = b - (x - a);
+			}
+
+			// Split a into two halves of at most 26 significant bits each.
+			static void split(double a, double& hi, double& lo){
+				double c = 134217729.0 * a; // 2^27 + 1
+				double a_big = c - a;
+				hi = c - a_big;
+				lo = a - hi;
+			}
+
+			static void two_product(double a, double b, double& x, double& y){
+				x = a * b;
+				double a_hi; double a_lo; double b_hi; double b_lo;
+				split(a, a_hi, a_lo);
+				split(b, b_hi, b_lo);
+				double err1 = x - (a_hi * b_hi);
+				double err2 = err1 - (a_lo * b_hi);
+				double err3 = err2 - (a_hi * b_lo);
+				y = (a_lo * b_lo) - err3;
+			}
+
+			// Compute h = e + f with zero elimination. Returns the size of h,
+			// which is at most elen + flen.
+			static std::size_t sum_zeroelim(std::size_t elen, const double* e, std::size_t flen, const double* f, double* h){
+				std::size_t eindex = 0;
+				std::size_t findex = 0;
+				std::size_t hindex = 0;
+				double enow = e[0];
+				double fnow = f[0];
+				double q;
+				double q_new;
+				double hh;
+				if( (fnow > enow) == (fnow > -enow) ){
+					q = enow;
+					enow = (++eindex < elen) ? e[eindex] : 0.0;
+				}
+				else{
+					q = fnow;
+					fnow = (++findex < flen) ? f[findex] : 0.0;
+				}
+				if( (eindex < elen) && (findex < flen) ){
+					if( (fnow > enow) == (fnow > -enow) ){
+						fast_two_sum(enow, q, q_new, hh);
+						enow = (++eindex < elen) ? e[eindex] : 0.0;
+					}
+					else{
+						fast_two_sum(fnow, q, q_new, hh);
+						fnow = (++findex < flen) ? f[findex] : 0.0;
+					}
+					q = q_new;
+					if(hh != 0.0){ h[hindex++] = hh; }
+					while( (eindex < elen) && (findex < flen) ){
+						if( (fnow > enow) == (fnow > -enow) ){
+							two_sum(q, enow, q_new, hh);
+							enow = (++eindex < elen) ? e[eindex] : 0.0;
+						}
+						else{
+							two_sum(q, fnow, q_new, hh);
+							fnow = (++findex < flen) ? f[findex] : 0.0;
+						}
+						q = q_new;
+						if(hh != 0.0){ h[hindex++] = hh; }
+					}
+				}
+				while(eindex < elen){
+					two_sum(q, enow, q_new, hh);
+					enow = (++eindex < elen) ? e[eindex] : 0.0;
+					q = q_new;
+					if(hh != 0.0){ h[hindex++] = hh; }
+				}
+				while(findex < flen){
+					two_sum(q, fnow, q_new, hh);
+					fnow = (++findex < flen) ? f[findex] : 0.0;
+					q = q_new;
+					if(hh != 0.0){ h[hindex++] = hh; }
+				}
+				if( (q != 0.0) || (hindex == 0) ){ h[hindex++] = q; }
+				return hindex;
+			}
+
+			// Compute h = e * b with zero elimination. Returns the size of h,
+			// which is at most 2 * elen.
+			static std::size_t scale_zeroelim(std::size_t elen, const double* e, double b, double* h){
+				std::size_t hindex = 0;
+				double q;
+				double hh;
+				two_product(e[0], b, q, hh);
+				if(hh != 0.0){ h[hindex++] = hh; }
+				for(std::size_t eindex = 1; eindex < elen; ++eindex){
+					double product1;
+					double product0;
+					double sum;
+					two_product(e[eindex], b, product1, product0);
+					two_sum(q, product0, sum, hh);
+					if(hh != 0.0){ h[hindex++] = hh; }
+					fast_two_sum(product1, sum, q, hh);
+					if(hh != 0.0){ h[hindex++] = hh; }
+				}
+				if( (q != 0.0) || (hindex == 0) ){ h[hindex++] = q; }
+				return hindex;
+			}
+
+			double* components_;
+			std::size_t size_;
+	};
+
+	// An upper bound on the number of components of an expansion, and on
+	// the storage of the arena used to compute it. Evaluating an expression
+	// on bounds instead of expansions gives the capacity of the arena that
+	// the expression needs on every input within an exponent bound.
+	// A value is bounded by the range of its bits: it is a multiple of
+	// 2^low and less than 2^high in magnitude. Since the components of an
+	// expansion are nonzero and nonoverlapping, and are multiples of 2^low
+	// like the value, there are at most high - low of them. The storage
+	// used by each operation mirrors the allocations (and trims) of the
+	// operations on expansions.
+	// The storage used is counted for the calling thread.
+	class expansion_bound {
+		public:
+			expansion_bound() : size_(1), low_(0), high_(0) {}
+
+			// Make the bound of an input value, whose binary exponent (as
+			// given by frexp) is within exponent_bound of zero.
+			static expansion_bound input(int exponent_bound) {
+				++arena_usage_count();
+				return expansion_bound(1, -exponent_bound - 53, exponent_bound);
+			}
+
+			std::size_t size() const { return size_; }
+
+			// Get the number of components allocated since the count was cleared.
+			static std::size_t arena_usage() { return arena_usage_count(); }
+			static void clear_arena_usage() { arena_usage_count() = 0; }
+
+			static expansion_bound add(const expansion_bound& obj_A, const expansion_bound& obj_B) {
+				expansion_bound result(obj_A.size_ + obj_B.size_, std::min(obj_A.low_, obj_B.low_), std::max(obj_A.high_, obj_B.high_) + 1);
+				arena_usage_count() += result.size_;
+				return result;
+			}
+
+			static expansion_bound negate(const expansion_bound& obj) {
+				arena_usage_count() += obj.size_;
+				return obj;
+			}
+
+			static expansion_bound multiply(const expansion_bound& obj_A, const expansion_bound& obj_B) {
+				if(obj_A.size_ < obj_B.size_){ return multiply(obj_B, obj_A); }
+				// The partial products, then the sum of the first i + 1 of them
+				// for each i. The sums are bounded like the product, since the
+				// sum of the first components of obj_B is less than twice its
+				// value in magnitude.
+				expansion_bound result(2*obj_A.size_*obj_B.size_, obj_A.low_ + obj_B.low_, obj_A.high_ + obj_B.high_ + 1);
+				std::size_t sum = 0;
+				arena_usage_count() += 2*obj_A.size_;
+				for(std::size_t i = 0; i < obj_B.size_; ++i){
+					sum = std::min(sum + 2*obj_A.size_, result.size_);
+					arena_usage_count() += sum;
+				}
+				return result;
+			}
+
+		private:
+			expansion_bound(std::size_t size, int low, int high) : size_(std::max<std::size_t>(1, std::min<std::size_t>(size, std::size_t(high - low)))), low_(low), high_(high) {}
+
+			static std::size_t& arena_usage_count() {
+				thread_local std::size_t count = 0;
+				return count;
+			}
+
+			std::size_t size_;
+			int low_;
+			int high_;
+	};
+
+	inline expansion_bound operator+(const expansion_bound& obj_A, const expansion_bound& obj_B){
+		return expansion_bound::add(obj_A, obj_B);
+	}
+
+	inline expansion_bound operator-(const expansion_bound& obj_A, const expansion_bound& obj_B){
+		return expansion_bound::add(obj_A, expansion_bound::negate(obj_B));
+	}
+
+	inline expansion_bound operator*(const expansion_bound& obj_A, const expansion_bound& obj_B){
+		return expansion_bound::multiply(obj_A, obj_B);
+	}
+
+	inline expansion operator+(const expansion& obj_A, const expansion& obj_B){
+		return expansion::add(obj_A, obj_B);
+	}
+
+	inline expansion operator-(const expansion& obj_A, const expansion& obj_B){
+		return expansion::add(obj_A, expansion::negate(obj_B));
+	}
+
+	inline expansion operator*(const expansion& obj_A, const expansion& obj_B){
+		return expansion::multiply(obj_A, obj_B);
+	}
+
+	inline bool operator<(const expansion& obj_A, const expansion& obj_B){
+		return ((obj_A - obj_B).sign() < 0);
+	}
+
+	inline bool operator>(const expansion& obj_A, const expansion& obj_B){
+		return ((obj_A - obj_B).sign() > 0);
+	}
+
+}
+#endif
@@ -115,12 +115,12 @@ namespace ra::math {
 		private:
 			real_type upper_;
 			real_type lower_;
-			static statistics stat_;
+			static thread_local statistics stat_;
 			
 	};
 	
 	template<class real_type>
-	typename interval<real_type>::statistics interval<real_type>::stat_ = interval<real_type>::make_stat();
+	thread_local typename interval<real_type>::statistics interval<real_type>::stat_ = interval<real_type>::make_stat();
 	
 	template<class real_type>
 	interval<real_type> operator+(const interval<real_type>& obj_A, const interval<real_type>& obj_B){
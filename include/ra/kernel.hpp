@@ -1,11 +1,43 @@
 #ifndef KERNEL_HPP
 #define KERNEL_HPP
-#include <CGAL/Cartesian.h>
+#include <CGAL/Simple_cartesian.h>
 #include <CGAL/MP_Float.h>
+#include <algorithm>
+#include <bitset>
 #include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <initializer_list>
+#include <limits>
 #include"ra/interval.hpp"
+#include"ra/expansion.hpp"
+#include"ra/alloc_profile.hpp"
 
 namespace ra::geometry {
+	// A direction whose coordinates are the compile-time constants X and
+	// Y. It may be passed wherever a direction vector is accepted, in
+	// which case the dot products of the preferred-directions tests are
+	// reduced at compile time (e.g., to a single coordinate for an
+	// axis-aligned direction, or to a sum or difference of the coordinates
+	// for a diagonal one), in the filtered and the exact paths alike.
+	template<int X, int Y>
+	struct Fixed_direction {
+		static_assert( (X != 0) || (Y != 0), "a direction is not the zero vector");
+		constexpr double x() const { return X; }
+		constexpr double y() const { return Y; }
+	};
+
+	// The first and second preferred directions (UX,UY) and (VX,VY) as
+	// compile-time constants (e.g., Pd_directions<1,0,1,1> for the
+	// directions used by our tools).
+	template<int UX, int UY, int VX, int VY>
+	struct Pd_directions {
+		using First = Fixed_direction<UX,UY>;
+		using Second = Fixed_direction<VX,VY>;
+		static constexpr First u{};
+		static constexpr Second v{};
+	};
+
 	// A geometry kernel with robust predicates.
 	template<class R>
 	class Kernel {
@@ -14,10 +46,20 @@ namespace ra::geometry {
 			using Real = R;
 			
 			// The type used to represent points in two dimensions.
-			using Point =typename CGAL::Cartesian<R>::Point_2;
+			// The coordinates of a point are stored in place (i.e., points
+			// are plain values and not reference-counted handles).
+			// Every test also accepts any other point type providing x()
+			// and y() (e.g., CGAL::Cartesian<R>::Point_2). Coordinates of
+			// a narrower type (e.g., the float coordinates of
+			// CGAL::Simple_cartesian<float>::Point_2) are promoted to R,
+			// which is exact, so the result is the same as for the points
+			// with the same values stored as R.
+			using Point = typename CGAL::Simple_cartesian<R>::Point_2;
 			
 			// The type used to represent vectors in two dimensions.
-			using Vector = typename CGAL::Cartesian<R>::Vector_2;
+			// Every test also accepts any other vector type providing x()
+			// and y() (e.g., CGAL::Cartesian<R>::Vector_2).
+			using Vector = typename CGAL::Simple_cartesian<R>::Vector_2;
 
 			// Type used for interval class
 			using itv = typename ra::math::interval<R>;
@@ -25,7 +67,53 @@ namespace ra::geometry {
 			using idr = typename ra::math::indeterminate_result;
 			// Type used for exact arithmetic
 			using exct = typename CGAL::MP_Float; 
-			
+			// Type used for exact arithmetic in the thread-local arena
+			using xpn = typename ra::math::expansion;
+			// Type used for scoping exact arithmetic in the thread-local arena
+			using xpn_scope = typename ra::math::expansion_scope;
+			// Type used for bounding the storage of exact arithmetic in the arena
+			using xpn_bound = typename ra::math::expansion_bound;
+			// Type used for exact arithmetic on small integer coordinates
+			using wide_int = __int128;
+
+			// The number of bits to which the magnitude of integer coordinates
+			// is bounded so that each test can be evaluated with wide_int
+			// arithmetic without overflow.
+			static constexpr int orientation_integer_bits = 52;
+			static constexpr int side_of_oriented_circle_integer_bits = 28;
+			static constexpr int preferred_direction_integer_bits = 18;
+
+			// The bound on the binary exponent of nonzero coordinates for
+			// which exact arithmetic is performed with expansions. Within it,
+			// no intermediate value of any test can overflow or underflow.
+			static constexpr int expansion_exponent_bound = 100;
+
+			// The parameters of the adaptive selection of the interval filter.
+			// The outcomes of the last filter_window filter attempts of each
+			// test are kept. When at least filter_skip_failures of them are
+			// failures, the filter is skipped and the test goes straight to
+			// exact arithmetic, except for one probe of the filter in every
+			// filter_probe_interval tests. The filter is used again once at
+			// most filter_resume_failures of the outcomes are failures.
+			static constexpr int filter_window = 64;
+			static constexpr int filter_skip_failures = 58;
+			static constexpr int filter_resume_failures = 32;
+			static constexpr int filter_probe_interval = 64;
+
+			// The tests whose interval filter is selected adaptively.
+			// The filter of needs_pd_flip is selected separately from those
+			// of the tests it combines, but its statistics are reported with
+			// the flippable-quadrilateral tests.
+			enum class Filter : int {
+				orientation = 0,
+				side_of_oriented_circle = 1,
+				preferred_direction = 2,
+				locally_pd_delaunay_edge = 3,
+				flippable_quad = 4,
+				needs_pd_flip = 5,
+			};
+			static constexpr int filter_count = 6;
+
 			// The possible outcomes of an orientation test.
 			enum class Orientation : int {
 				right_turn = -1,
@@ -41,19 +129,108 @@ namespace ra::geometry {
 			};
 
 			// The set of statistics maintained by the kernel.
+			// The statistics are maintained separately for each thread.
+			// The allocation counts are those of the expansion arena; the
+			// exact arithmetic with exct (for coordinates outside
+			// expansion_exponent_bound) also allocates, which is not counted.
 			struct Statistics {
 				// The total number of orientation tests.
 				std::size_t orientation_total_count;
 				// The number of orientation tests requiring exact arithmetic
 				std::size_t orientation_exact_count;
+				// The number of heap allocations made by the exact arithmetic of orientation tests
+				std::size_t orientation_exact_allocation_count;
+				// The number of orientation tests evaluated with integer arithmetic
+				std::size_t orientation_integer_count;
+				// The number of orientation tests that skipped the interval filter
+				std::size_t orientation_filter_skip_count;
+				// The number of times the interval filter of orientation tests was switched off or on
+				std::size_t orientation_filter_switch_count;
 				// The total number of preferred-direction tests.
 				std::size_t preferred_direction_total_count;
 				// The number of preferred-direction tests requiring exact arithmetic
 				std::size_t preferred_direction_exact_count;
+				// The number of heap allocations made by the exact arithmetic of preferred-direction tests
+				std::size_t preferred_direction_exact_allocation_count;
+				// The number of preferred-direction tests evaluated with integer arithmetic
+				std::size_t preferred_direction_integer_count;
+				// The number of preferred-direction tests that skipped the interval filter
+				std::size_t preferred_direction_filter_skip_count;
+				// The number of times the interval filter of preferred-direction tests was switched off or on
+				std::size_t preferred_direction_filter_switch_count;
 				// The total number of side-of-oriented-circle tests.
 				std::size_t side_of_oriented_circle_total_count;
 				// The number of side-of-oriented-circle tests requiring exact arithmetic
 				std::size_t side_of_oriented_circle_exact_count;
+				// The number of heap allocations made by the exact arithmetic of side-of-oriented-circle tests
+				std::size_t side_of_oriented_circle_exact_allocation_count;
+				// The number of side-of-oriented-circle tests evaluated with integer arithmetic
+				std::size_t side_of_oriented_circle_integer_count;
+				// The number of side-of-oriented-circle tests that skipped the interval filter
+				std::size_t side_of_oriented_circle_filter_skip_count;
+				// The number of times the interval filter of side-of-oriented-circle tests was switched off or on
+				std::size_t side_of_oriented_circle_filter_switch_count;
+				// The number of side-of-oriented-circle tests on cached points decided by the semi-static filter
+				std::size_t side_of_oriented_circle_semi_static_count;
+				// The total number of preferred-directions locally-Delaunay edge tests.
+				std::size_t locally_pd_delaunay_edge_total_count;
+				// The number of preferred-directions locally-Delaunay edge tests requiring exact arithmetic
+				std::size_t locally_pd_delaunay_edge_exact_count;
+				// The number of heap allocations made by the exact arithmetic of preferred-directions locally-Delaunay edge tests
+				std::size_t locally_pd_delaunay_edge_exact_allocation_count;
+				// The number of preferred-directions locally-Delaunay edge tests evaluated with integer arithmetic
+				std::size_t locally_pd_delaunay_edge_integer_count;
+				// The number of preferred-directions locally-Delaunay edge tests that skipped the interval filter
+				std::size_t locally_pd_delaunay_edge_filter_skip_count;
+				// The number of times the interval filter of preferred-directions locally-Delaunay edge tests was switched off or on
+				std::size_t locally_pd_delaunay_edge_filter_switch_count;
+				// The number of preferred-directions locally-Delaunay edge tests decided by the tie-break
+				std::size_t locally_pd_delaunay_edge_tie_count;
+				// The total number of flippable-quadrilateral tests.
+				std::size_t flippable_quad_total_count;
+				// The number of flippable-quadrilateral tests requiring exact arithmetic
+				std::size_t flippable_quad_exact_count;
+				// The number of heap allocations made by the exact arithmetic of flippable-quadrilateral tests
+				std::size_t flippable_quad_exact_allocation_count;
+				// The number of flippable-quadrilateral tests evaluated with integer arithmetic
+				std::size_t flippable_quad_integer_count;
+				// The number of flippable-quadrilateral tests that skipped the interval filter
+				std::size_t flippable_quad_filter_skip_count;
+				// The number of times the interval filter of flippable-quadrilateral tests was switched off or on
+				std::size_t flippable_quad_filter_switch_count;
+				// The number of needs_pd_flip tests on cached points decided by the semi-static filter
+				std::size_t flippable_quad_semi_static_count;
+			};
+
+			// A point with the values that depend on it alone, computed once
+			// (e.g., per vertex of a triangulation) and shared by every test
+			// on the point: its lifted coordinate x^2+y^2 as a tight interval
+			// (for the interval filter) and the magnitude of its coordinates
+			// (for the error bound of the semi-static filter). A cached point
+			// is also a point type (i.e., it provides x() and y()).
+			struct Cached_point {
+				Real px;
+				Real py;
+				// The bounds of the interval containing x^2+y^2.
+				Real lifted_lower;
+				Real lifted_upper;
+				// The largest magnitude of the coordinates.
+				Real magnitude;
+				// Whether the coordinates are double precision and zero or within
+				// the exponent range in which the semi-static filter neither
+				// underflows nor overflows.
+				bool filter_safe;
+				Real x() const { return px; }
+				Real y() const { return py; }
+			};
+
+			// The coordinate differences of the quadrilateral abcd, translated
+			// so that d is the origin, shared by the tests on the quadrilateral.
+			template<class NT>
+			struct Quad_differences {
+				NT adx; NT ady;
+				NT bdx; NT bdy;
+				NT cdx; NT cdy;
 			};
 
 			// Since a kernel object is stateless, construction and destruction are trivial
@@ -84,60 +261,396 @@ namespace ra::geometry {
 				DDR det = (m[0][0]*determinant_3_by_3(sub0)) - (m[1][0]*determinant_3_by_3(sub1)) + (m[2][0]*determinant_3_by_3(sub2)) - (m[3][0]*determinant_3_by_3(sub3));
 				return det;
 			}
+
+			// Tests if every value is an integer whose magnitude is less than 2^bits.
+			static bool are_bounded_integers(int bits, std::initializer_list<Real> values) {
+				const Real bound = std::ldexp(Real(1), bits);
+				for(const Real& x : values){
+					if( (std::trunc(x) != x) || !(std::abs(x) < bound) ){ return false; }
+				}
+				return true;
+			}
+
+			// Member function to get the sign of a wide integer
+			static int sign_of(wide_int x) {
+				return (x > 0) - (x < 0);
+			}
+
+			// Tests if every value is zero or has a binary exponent within the
+			// bound for which exact arithmetic is performed with expansions.
+			static bool are_expansion_safe(std::initializer_list<Real> values) {
+				if(std::numeric_limits<Real>::digits > std::numeric_limits<double>::digits){ return false; }
+				for(const Real& x : values){
+					if(x == Real(0)){ continue; }
+					if(!std::isfinite(x)){ return false; }
+					int exponent;
+					std::frexp(x,&exponent);
+					if( (exponent > expansion_exponent_bound) || (exponent < -expansion_exponent_bound) ){ return false; }
+				}
+				return true;
+			}
+
+			// Member functions to get the number of components of the arena
+			// that the exact evaluation of a test with expansions can use, on
+			// coordinates within expansion_exponent_bound. Each is computed
+			// once, by evaluating the test on expansion bounds, and reserved
+			// by every exact evaluation of the test, so that the exact tests
+			// make no heap allocation once the arena of a thread has grown to
+			// it. The sign of a bound is zero, so the bound of the tie-break
+			// of the preferred-directions tests includes both directions.
+			// (For directions that are not fixed at compile time, this is
+			// about 2^18 components, but the storage reserved and not used is
+			// never touched. The incircle test needs about 2^13.)
+			template<class F>
+			static std::size_t arena_usage(F evaluate) {
+				xpn_bound::clear_arena_usage();
+				evaluate();
+				return xpn_bound::arena_usage();
+			}
+			static Quad_differences<xpn_bound> bound_quad_differences() {
+				Point p(0,0);
+				return make_quad_differences<xpn_bound>(p,p,p,p);
+			}
+			static std::size_t orientation_capacity() {
+				static const std::size_t capacity = arena_usage([](){ Point p(0,0); orientation_sign<xpn_bound>(p,p,p); });
+				return capacity;
+			}
+			static std::size_t side_of_oriented_circle_capacity() {
+				static const std::size_t capacity = arena_usage([](){ side_of_oriented_circle_sign(bound_quad_differences()); });
+				return capacity;
+			}
+			// Both orientations of is_convex_across_diagonal
+			static std::size_t flippable_quad_capacity() {
+				static const std::size_t capacity = arena_usage([](){
+					Quad_differences<xpn_bound> q = bound_quad_differences();
+					(q.bdx*q.cdy) - (q.bdy*q.cdx);
+					(q.adx*q.bdy) - (q.ady*q.bdx);
+				});
+				return capacity;
+			}
+			template<class V>
+			static std::size_t preferred_direction_capacity(const V& v) {
+				static const std::size_t capacity = arena_usage([&v](){ Point p(0,0); preferred_direction_sign<xpn_bound>(p,p,p,p,v); });
+				return capacity;
+			}
+			template<class U, class V>
+			static std::size_t locally_pd_delaunay_edge_capacity(const U& u, const V& v) {
+				static const std::size_t capacity = arena_usage([&u,&v](){
+					Quad_differences<xpn_bound> q = bound_quad_differences();
+					side_of_oriented_circle_sign(q);
+					pd_tie_break(q,u,v);
+				});
+				return capacity;
+			}
+
+			// Member functions to get the sign of an interval, exact, expansion or wide integer number
+			static int sign_of(const itv& x) {
+				return x.sign();
+			}
+			static int sign_of(const xpn& x) {
+				return x.sign();
+			}
+			static int sign_of(const xpn_bound&) {
+				return 0;
+			}
+			static int sign_of(const exct& x) {
+				if(x < exct(0)){ return -1; }
+				else if(x > exct(0)){ return 1; }
+				else{ return 0; }
+			}
+
+			// Member functions to compute an interval containing the lifted
+			// coordinate x^2+y^2 of a point (which a cached point holds).
+			template<class P>
+			static itv lifted_interval(const P& p) {
+				itv x(p.x()); itv y(p.y());
+				return (x*x)+(y*y);
+			}
+			static itv lifted_interval(const Cached_point& p) {
+				return itv(p.lifted_lower,p.lifted_upper);
+			}
+
+			// Member function to compute the sign of the orientation
+			// determinant (a-c)x(b-c) with floating-point arithmetic and a
+			// semi-static error bound (that of Shewchuk's orient2d, with a
+			// unit roundoff of one ulp so that it holds in any rounding
+			// mode). Returns 2 if the sign cannot be decided.
+			// Precondition: The coordinates are safe for the filter.
+			static int semi_static_orientation_sign(const Cached_point& a, const Cached_point& b, const Cached_point& c) {
+				constexpr Real eps = std::numeric_limits<Real>::epsilon();
+				constexpr Real bound_factor = (Real(3) + (Real(16) * eps)) * eps;
+				Real left = (a.px - c.px) * (b.py - c.py);
+				Real right = (a.py - c.py) * (b.px - c.px);
+				Real det = left - right;
+				Real bound = bound_factor * (std::abs(left) + std::abs(right));
+				if(det > bound){ return 1; }
+				else if(-det > bound){ return -1; }
+				else{ return 2; }
+			}
+
+			// Member function to compute the sign of the side-of-oriented-circle
+			// determinant of the cached points a, b, c, and d with
+			// floating-point arithmetic, from their cached lifted coordinates.
+			// The error of the 24 terms of the 4 by 4 determinant (each a
+			// product of two coordinates and a lifted coordinate, with at most
+			// 11 roundings including those of the lifted coordinate) is at most
+			// 11 ulps of 24 * M^2 * L, where M and L are the largest magnitude
+			// and lifted coordinate of the points. Returns 2 if the sign cannot
+			// be decided.
+			// Precondition: The coordinates are safe for the filter.
+			static int semi_static_side_of_oriented_circle_sign(const Cached_point& a, const Cached_point& b, const Cached_point& c, const Cached_point& d) {
+				constexpr Real bound_factor = Real(24 * 12) * std::numeric_limits<Real>::epsilon();
+				Real matrix[4][4] = {a.px,b.px,c.px,d.px,a.py,b.py,c.py,d.py,a.lifted_upper,b.lifted_upper,c.lifted_upper,d.lifted_upper,
+				  Real(1),Real(1),Real(1),Real(1)};
+				Real det = determinant_4_by_4(matrix);
+				Real m = std::max(std::max(a.magnitude,b.magnitude),std::max(c.magnitude,d.magnitude));
+				Real l = std::max(std::max(a.lifted_upper,b.lifted_upper),std::max(c.lifted_upper,d.lifted_upper));
+				Real bound = bound_factor * ((m*m)*l);
+				if(det > bound){ return 1; }
+				else if(-det > bound){ return -1; }
+				else{ return 2; }
+			}
+
+			// Member functions to convert a coordinate to the number type
+			// used for evaluating a test
+			static void convert(Real x, wide_int& result) {
+				result = static_cast<std::int64_t>(x);
+			}
+			template<class NT>
+			static void convert(Real x, NT& result) {
+				result = NT(x);
+			}
+			static void convert(Real, xpn_bound& result) {
+				result = xpn_bound::input(expansion_exponent_bound);
+			}
+
+			// Member function to compute the coordinate differences of the
+			// quadrilateral abcd in the number type NT
+			template<class NT, class P>
+			static Quad_differences<NT> make_quad_differences(const P& a, const P& b, const P& c, const P& d) {
+				NT ax; NT ay; NT bx; NT by; NT cx; NT cy; NT dx; NT dy;
+				convert(a.x(),ax); convert(a.y(),ay); convert(b.x(),bx); convert(b.y(),by);
+				convert(c.x(),cx); convert(c.y(),cy); convert(d.x(),dx); convert(d.y(),dy);
+				return Quad_differences<NT>{ax-dx,ay-dy,bx-dx,by-dy,cx-dx,cy-dy};
+			}
+
+			// Member function to compute the sign of the side-of-oriented-circle
+			// determinant from the coordinate differences of a quadrilateral
+			template<class NT>
+			static int side_of_oriented_circle_sign(const Quad_differences<NT>& q) {
+				NT matrix[3][3] = {q.adx,q.ady,(q.adx*q.adx)+(q.ady*q.ady),q.bdx,q.bdy,(q.bdx*q.bdx)+(q.bdy*q.bdy),q.cdx,q.cdy,(q.cdx*q.cdx)+(q.cdy*q.cdy)};
+				return sign_of(determinant_3_by_3(matrix));
+			}
+
+			// Member function to test if the quadrilateral abcd, whose triangles
+			// abc and acd are CCW, is strictly convex, from its coordinate
+			// differences. Only the orientations of bcd and dab, which lie
+			// across the diagonal ac, need to be tested.
+			template<class NT>
+			static bool is_convex_across_diagonal(const Quad_differences<NT>& q) {
+				if( sign_of( (q.bdx*q.cdy) - (q.bdy*q.cdx) ) <= 0 ){ return false; }
+				return ( sign_of( (q.adx*q.bdy) - (q.ady*q.bdx) ) > 0 );
+			}
+
+			// Member functions to compute the dot product of the vector (x,y)
+			// with the direction v, up to sign (since the preferred-directions
+			// tests only use its square). For a direction with compile-time
+			// coordinates, the multiplications by zero and one are omitted.
+			template<class NT, class V>
+			static NT direction_dot(const NT& x, const NT& y, const V& v) {
+				NT vx; NT vy;
+				convert(v.x(),vx); convert(v.y(),vy);
+				return (x*vx) + (y*vy);
+			}
+			template<int K, class NT>
+			static NT scaled(const NT& x) {
+				if constexpr( (K == 1) || (K == -1) ){ return x; }
+				else{
+					NT k;
+					convert(Real(K < 0 ? -K : K),k);
+					return x*k;
+				}
+			}
+			template<class NT, int X, int Y>
+			static NT direction_dot(const NT& x, const NT& y, const Fixed_direction<X,Y>&) {
+				if constexpr(X == 0){ return scaled<Y>(y); }
+				else if constexpr(Y == 0){ return scaled<X>(x); }
+				else if constexpr(X == Y){ return scaled<X>(x + y); }
+				else if constexpr(X == -Y){ return scaled<X>(x - y); }
+				else if constexpr( (X < 0) == (Y < 0) ){ return scaled<X>(x) + scaled<Y>(y); }
+				else{ return scaled<X>(x) - scaled<Y>(y); }
+			}
+
+			// Member function to compute the preferred-directions tie-break of
+			// the diagonal ac against the diagonal bd of a quadrilateral, with
+			// respect to the first and second directions u and v.
+			// The lengths of the diagonals are shared by both directions.
+			template<class NT, class U, class V>
+			static bool pd_tie_break(const Quad_differences<NT>& q, const U& u, const V& v) {
+				NT acx = q.cdx - q.adx; NT acy = q.cdy - q.ady;
+				NT ac_len = (acx*acx) + (acy*acy);
+				NT bd_len = (q.bdx*q.bdx) + (q.bdy*q.bdy);
+				NT ac_u = direction_dot(acx,acy,u);
+				NT bd_u = direction_dot(q.bdx,q.bdy,u);
+				int first = sign_of( (bd_len*(ac_u*ac_u)) - (ac_len*(bd_u*bd_u)) );
+				if(first != 0){ return (first > 0); }
+				NT ac_v = direction_dot(acx,acy,v);
+				NT bd_v = direction_dot(q.bdx,q.bdy,v);
+				return ( sign_of( (bd_len*(ac_v*ac_v)) - (ac_len*(bd_v*bd_v)) ) > 0 );
+			}
+
+			// Member function to evaluate the preferred-directions locally-Delaunay
+			// test from the coordinate differences of a quadrilateral.
+			// tie is set if the preferred-directions tie-break was needed.
+			template<class NT, class U, class V>
+			static bool is_locally_pd_delaunay_quad(const Quad_differences<NT>& q, const U& u, const V& v, bool& tie) {
+				int side = side_of_oriented_circle_sign(q);
+				tie = (side == 0);
+				if(side != 0){ return (side < 0); }
+				return pd_tie_break(q,u,v);
+			}
+
+			// Member function to compute the sign of the orientation
+			// determinant in the number type NT
+			template<class NT, class P>
+			static int orientation_sign(const P& a, const P& b, const P& c) {
+				NT ax; NT ay; NT bx; NT by; NT cx; NT cy;
+				convert(a.x(),ax); convert(a.y(),ay); convert(b.x(),bx); convert(b.y(),by); convert(c.x(),cx); convert(c.y(),cy);
+				NT det = ((bx-ax)*(cy-ay)) - ((by-ay)*(cx-ax));
+				return sign_of(det);
+			}
+
+			// Member function to compute the sign of the preferred-direction
+			// expression in the number type NT
+			template<class NT, class P, class V>
+			static int preferred_direction_sign(const P& a, const P& b, const P& c, const P& d, const V& v) {
+				NT ax; NT ay; NT bx; NT by; NT cx; NT cy; NT dx; NT dy;
+				convert(a.x(),ax); convert(a.y(),ay); convert(b.x(),bx); convert(b.y(),by);
+				convert(c.x(),cx); convert(c.y(),cy); convert(d.x(),dx); convert(d.y(),dy);
+				NT abx = bx - ax; NT aby = by - ay;
+				NT cdx = dx - cx; NT cdy = dy - cy;
+				NT first = (cdx*cdx) + (cdy*cdy);
+				NT second_inc = direction_dot(abx,aby,v);
+				NT third = (abx*abx) + (aby*aby);
+				NT fourth_inc = direction_dot(cdx,cdy,v);
+				NT result = (first * (second_inc*second_inc)) - (third * (fourth_inc*fourth_inc));
+				return sign_of(result);
+			}
 			
 			// Determines how the point c is positioned relative to the
 			// directed line through the points a and b (in that order).
 			// Precondition: The points a and b have distinct values.
-			Orientation orientation(const Point& a, const Point& b, const Point& c) const {
-				try{
-					++(stat_.orientation_total_count);
-					itv ax(a.x()); itv ay(a.y()); itv bx(b.x()); itv by(b.y()); itv cx(c.x()); itv cy(c.y());
-					itv matrix[3][3] = {ax,bx,cx,ay,by,cy,itv(1.0),itv(1.0),itv(1.0)};
-					itv det = determinant_3_by_3(matrix);
-					if( (det.sign()) == -1 ) { return (Orientation::right_turn); }
-					else if( (det.sign()) == 1 ) { return (Orientation::left_turn); }
+			template<class P>
+			Orientation orientation(const P& a, const P& b, const P& c) const {
+				++(stat_.orientation_total_count);
+				if(are_bounded_integers(orientation_integer_bits,{a.x(),a.y(),b.x(),b.y(),c.x(),c.y()})){
+					++(stat_.orientation_integer_count);
+					int sgn = orientation_sign<wide_int>(a,b,c);
+					if(sgn == -1){ return (Orientation::right_turn); }
+					else if(sgn == 1){ return (Orientation::left_turn); }
 					else{ return (Orientation::collinear); }
 				}
-				catch(const idr& e){
-					++(stat_.orientation_exact_count);
-					exct matrix[3][3] = {(a.x()),(b.x()),(c.x()),(a.y()),(b.y()),(c.y()),exct(1.0),exct(1.0),exct(1.0)};
-					exct det = determinant_3_by_3(matrix);
-					if(det < exct(0)){ return (Orientation::right_turn); }
-					else if(det > exct(0)){ return (Orientation::left_turn); }
-					else{ return (Orientation::collinear); }
+				int sgn;
+				if(use_filter(Filter::orientation,stat_.orientation_filter_skip_count)){
+					try{
+						itv ax(a.x()); itv ay(a.y()); itv bx(b.x()); itv by(b.y()); itv cx(c.x()); itv cy(c.y());
+						itv matrix[3][3] = {ax,bx,cx,ay,by,cy,itv(1.0),itv(1.0),itv(1.0)};
+						sgn = determinant_3_by_3(matrix).sign();
+						record_filter(Filter::orientation,false,stat_.orientation_filter_switch_count);
+						if(sgn == -1){ return (Orientation::right_turn); }
+						else if(sgn == 1){ return (Orientation::left_turn); }
+						else{ return (Orientation::collinear); }
+					}
+					catch(const idr& e){
+						record_filter(Filter::orientation,true,stat_.orientation_filter_switch_count);
+					}
+				}
+				++(stat_.orientation_exact_count);
+				RA_ALLOC_SCOPE(ra::profile::Region::orientation_exact);
+				if(are_expansion_safe({a.x(),a.y(),b.x(),b.y(),c.x(),c.y()})){
+					xpn_scope scope(orientation_capacity());
+					sgn = orientation_sign<xpn>(a,b,c);
+					stat_.orientation_exact_allocation_count += scope.heap_allocation_count();
 				}
+				else{
+					sgn = orientation_sign<exct>(a,b,c);
+				}
+				if(sgn == -1){ return (Orientation::right_turn); }
+				else if(sgn == 1){ return (Orientation::left_turn); }
+				else{ return (Orientation::collinear); }
 			}
 
 			// Determines how the point d is positioned relative to the
 			// oriented circle passing through the points a, b, and c
 			// (in that order).
 			// Precondition: The points a, b, and c are not collinear.
-			Oriented_side side_of_oriented_circle(const Point& a, const Point& b, const Point& c, const Point& d)const{
-				try{
-					++(stat_.side_of_oriented_circle_total_count);
-					itv ax(a.x()); itv ay(a.y()); itv bx(b.x()); itv by(b.y()); itv cx(c.x()); itv cy(c.y());
-					itv dx(d.x()); itv dy(d.y());
-					itv ar((ax*ax)+(ay*ay)); itv br((bx*bx)+(by*by)); itv cr((cx*cx)+(cy*cy));
-					itv dr((dx*dx)+(dy*dy));
-					itv matrix[4][4] = {ax,bx,cx,dx,ay,by,cy,dy,ar,br,cr,dr,itv(1.0),itv(1.0),itv(1.0),itv(1.0)};
-					itv det = determinant_4_by_4(matrix);
-					if( (det.sign()) == -1 ) { return (Oriented_side::on_negative_side); }
-					else if( (det.sign()) == 1 ) { return (Oriented_side::on_positive_side); }
+			template<class P>
+			Oriented_side side_of_oriented_circle(const P& a, const P& b, const P& c, const P& d)const{
+				++(stat_.side_of_oriented_circle_total_count);
+				if(are_bounded_integers(side_of_oriented_circle_integer_bits,{a.x(),a.y(),b.x(),b.y(),c.x(),c.y(),d.x(),d.y()})){
+					++(stat_.side_of_oriented_circle_integer_count);
+					int sgn = side_of_oriented_circle_sign(make_quad_differences<wide_int>(a,b,c,d));
+					if(sgn == -1){ return (Oriented_side::on_negative_side); }
+					else if(sgn == 1){ return (Oriented_side::on_positive_side); }
 					else{ return (Oriented_side::on_boundary); }
 				}
-				catch(const idr& e){
-					++(stat_.side_of_oriented_circle_exact_count);
-					exct ax(a.x()); exct ay(a.y()); exct bx(b.x()); exct by(b.y()); 
-					exct cx(c.x()); exct cy(c.y());
-					exct dx(d.x()); exct dy(d.y());
-					exct ar((ax*ax)+(ay*ay)); exct br((bx*bx)+(by*by)); exct cr((cx*cx)+(cy*cy));
-					exct dr((dx*dx)+(dy*dy));
-					exct matrix[4][4] = {ax,bx,cx,dx,ay,by,cy,dy,ar,br,cr,dr,exct(1.0),exct(1.0),exct(1.0),exct(1.0)};
-					exct det = determinant_4_by_4(matrix);
-					if(det < exct(0)){ return (Oriented_side::on_negative_side); }
-					else if(det > exct(0)){ return (Oriented_side::on_positive_side); }
-					else{ return (Oriented_side::on_boundary); }
+				int sgn;
+				if(use_filter(Filter::side_of_oriented_circle,stat_.side_of_oriented_circle_filter_skip_count)){
+					try{
+						itv ax(a.x()); itv ay(a.y()); itv bx(b.x()); itv by(b.y()); itv cx(c.x()); itv cy(c.y());
+						itv dx(d.x()); itv dy(d.y());
+						itv ar(lifted_interval(a)); itv br(lifted_interval(b)); itv cr(lifted_interval(c));
+						itv dr(lifted_interval(d));
+						itv matrix[4][4] = {ax,bx,cx,dx,ay,by,cy,dy,ar,br,cr,dr,itv(1.0),itv(1.0),itv(1.0),itv(1.0)};
+						sgn = determinant_4_by_4(matrix).sign();
+						record_filter(Filter::side_of_oriented_circle,false,stat_.side_of_oriented_circle_filter_switch_count);
+						if(sgn == -1){ return (Oriented_side::on_negative_side); }
+						else if(sgn == 1){ return (Oriented_side::on_positive_side); }
+						else{ return (Oriented_side::on_boundary); }
+					}
+					catch(const idr& e){
+						record_filter(Filter::side_of_oriented_circle,true,stat_.side_of_oriented_circle_filter_switch_count);
+					}
+				}
+				++(stat_.side_of_oriented_circle_exact_count);
+				RA_ALLOC_SCOPE(ra::profile::Region::side_of_oriented_circle_exact);
+				if(are_expansion_safe({a.x(),a.y(),b.x(),b.y(),c.x(),c.y(),d.x(),d.y()})){
+					xpn_scope scope(side_of_oriented_circle_capacity());
+					sgn = side_of_oriented_circle_sign(make_quad_differences<xpn>(a,b,c,d));
+					stat_.side_of_oriented_circle_exact_allocation_count += scope.heap_allocation_count();
+				}
+				else{
+					sgn = side_of_oriented_circle_sign(make_quad_differences<exct>(a,b,c,d));
 				}
+				if(sgn == -1){ return (Oriented_side::on_negative_side); }
+				else if(sgn == 1){ return (Oriented_side::on_positive_side); }
+				else{ return (Oriented_side::on_boundary); }
+			}
+
+			// Determines how the cached point d is positioned relative to the
+			// oriented circle passing through the cached points a, b, and c,
+			// trying the semi-static filter on their cached values first.
+			// The interval filter also uses the cached lifted coordinates.
+			// Precondition: The points a, b, and c are not collinear.
+			Oriented_side side_of_oriented_circle(const Cached_point& a, const Cached_point& b, const Cached_point& c, const Cached_point& d) const {
+				if(a.filter_safe && b.filter_safe && c.filter_safe && d.filter_safe){
+					int sgn = semi_static_side_of_oriented_circle_sign(a,b,c,d);
+					if(sgn != 2){
+						++(stat_.side_of_oriented_circle_total_count);
+						++(stat_.side_of_oriented_circle_semi_static_count);
+						return (sgn < 0) ? Oriented_side::on_negative_side : Oriented_side::on_positive_side;
+					}
+				}
+				return side_of_oriented_circle<Cached_point>(a,b,c,d);
+			}
+
+			// Make a point with the cached values of the point p.
+			template<class P>
+			static Cached_point make_cached_point(const P& p) {
+				Real x(p.x()); Real y(p.y());
+				itv lifted = lifted_interval(p);
+				return Cached_point{x, y, lifted.lower(), lifted.upper(), std::max(std::abs(x),std::abs(y)),
+				  (std::numeric_limits<Real>::digits == std::numeric_limits<double>::digits) && are_expansion_safe({x,y})};
 			}
 
 			// Determines if, compared to the orientation of line
@@ -151,44 +664,49 @@ namespace ra::geometry {
 			// Precondition: The points a and b have distinct values; the
 			// points c and d have distinct values; the vector v is not
 			// the zero vector.
-			int preferred_direction(const Point& a,const Point& b,const Point& c,const Point& d,const Vector& v)const{
-				try{
-					++(stat_.preferred_direction_total_count);
-					itv ax(a.x()); itv ay(a.y()); itv bx(b.x()); itv by(b.y());
-					itv cx(c.x()); itv cy(c.y()); itv dx(d.x()); itv dy(d.y());
-					itv vx(v.x()); itv vy(v.y());
-					itv first = ( (dx-cx)*(dx-cx) ) + ( (dy-cy)*(dy-cy) );
-					itv second_inc = ( (bx-ax)*(vx) ) + ( (by-ay)*(vy) );
-					itv second = second_inc * second_inc;
-					itv third = ( (bx-ax)*(bx-ax) ) + ( (by-ay)*(by-ay) );
-					itv fourth_inc = ( (dx-cx)*(vx) ) + ( (dy-cy)*(vy) );
-					itv fourth = fourth_inc * fourth_inc;
-					itv result = (first * second) - (third * fourth);
-					return (result.sign());
+			template<class P, class V>
+			int preferred_direction(const P& a,const P& b,const P& c,const P& d,const V& v)const{
+				++(stat_.preferred_direction_total_count);
+				if(are_bounded_integers(preferred_direction_integer_bits,{a.x(),a.y(),b.x(),b.y(),c.x(),c.y(),d.x(),d.y(),v.x(),v.y()})){
+					++(stat_.preferred_direction_integer_count);
+					return preferred_direction_sign<wide_int>(a,b,c,d,v);
 				}
-				catch(const idr& e){
-					++(stat_.preferred_direction_exact_count);
-					exct ax(a.x()); exct ay(a.y()); exct bx(b.x()); exct by(b.y());
-					exct cx(c.x()); exct cy(c.y()); exct dx(d.x()); exct dy(d.y());
-					exct vx(v.x()); exct vy(v.y());
-					exct first = ( (dx-cx)*(dx-cx) ) + ( (dy-cy)*(dy-cy) );
-					exct second_inc = ( (bx-ax)*(vx) ) + ( (by-ay)*(vy) );
-					exct second = second_inc * second_inc;
-					exct third = ( (bx-ax)*(bx-ax) ) + ( (by-ay)*(by-ay) );
-					exct fourth_inc = ( (dx-cx)*(vx) ) + ( (dy-cy)*(vy) );
-					exct fourth = fourth_inc * fourth_inc;
-					exct result = (first * second) - (third * fourth);
-					if( result < exct(0) ) { return -1; }
-					else if( result > exct(0) ) { return 1; }
-					else { return 0; }
+				if(use_filter(Filter::preferred_direction,stat_.preferred_direction_filter_skip_count)){
+					try{
+						itv ax(a.x()); itv ay(a.y()); itv bx(b.x()); itv by(b.y());
+						itv cx(c.x()); itv cy(c.y()); itv dx(d.x()); itv dy(d.y());
+						itv first = ( (dx-cx)*(dx-cx) ) + ( (dy-cy)*(dy-cy) );
+						itv second_inc = direction_dot(bx-ax,by-ay,v);
+						itv second = second_inc * second_inc;
+						itv third = ( (bx-ax)*(bx-ax) ) + ( (by-ay)*(by-ay) );
+						itv fourth_inc = direction_dot(dx-cx,dy-cy,v);
+						itv fourth = fourth_inc * fourth_inc;
+						itv result = (first * second) - (third * fourth);
+						int sgn = result.sign();
+						record_filter(Filter::preferred_direction,false,stat_.preferred_direction_filter_switch_count);
+						return sgn;
+					}
+					catch(const idr& e){
+						record_filter(Filter::preferred_direction,true,stat_.preferred_direction_filter_switch_count);
+					}
+				}
+				++(stat_.preferred_direction_exact_count);
+				RA_ALLOC_SCOPE(ra::profile::Region::preferred_direction_exact);
+				if(are_expansion_safe({a.x(),a.y(),b.x(),b.y(),c.x(),c.y(),d.x(),d.y(),v.x(),v.y()})){
+					xpn_scope scope(preferred_direction_capacity(v));
+					int sgn = preferred_direction_sign<xpn>(a,b,c,d,v);
+					stat_.preferred_direction_exact_allocation_count += scope.heap_allocation_count();
+					return sgn;
 				}
+				return preferred_direction_sign<exct>(a,b,c,d,v);
 			}
 
 			// Tests if the quadrilateral with vertices a, b, c, and d
 			// specified in CCW order is strictly convex.
 			// Precondition: The vertices a, b, c, and d have distinct
 			// values and are specified in CCW order.
-			bool is_strictly_convex_quad(const Point& a,const Point& b,const Point& c,const Point& d) const {
+			template<class P>
+			bool is_strictly_convex_quad(const P& a,const P& b,const P& c,const P& d) const {
 				Orientation t_1 = orientation(a,b,c);
 				Orientation t_2 = orientation(b,c,d);
 				Orientation t_3 = orientation(c,d,a);
@@ -203,7 +721,8 @@ namespace ra::geometry {
 			// two incident faces abc and acd, is locally Delaunay.
 			// Precondition: The points a, b, c, and d have distinct
 			// values; the quadrilateral abcd must be strictly convex.
-			bool is_locally_delaunay_edge(const Point& a,const Point& b,const Point& c,const Point& d)const{
+			template<class P>
+			bool is_locally_delaunay_edge(const P& a,const P& b,const P& c,const P& d)const{
 				Oriented_side tst = side_of_oriented_circle(a,b,c,d);
 				if(tst == Oriented_side::on_positive_side){ return false; }
 				else{ return true; }
@@ -216,27 +735,235 @@ namespace ra::geometry {
 			// Precondition: The points a, b, c, and d have distinct values;
 			// the vectors u and v are not zero vectors; the vectors u and
 			// v are neither parallel nor orthogonal.
-			bool is_locally_pd_delaunay_edge(const Point& a,const Point& b,const Point& c,const Point& d,const Vector& u,const Vector& v)const{
-				Oriented_side tst = side_of_oriented_circle(a,b,c,d);
-				if(tst == Oriented_side::on_positive_side){ return false; }
-				else if(tst == Oriented_side::on_negative_side){ return true; }
+			// The coordinate differences are computed once per number type and
+			// shared by the side-of-oriented-circle test and the tie-break.
+			// The directions may be given as Fixed_direction (or as
+			// Pd_directions, see below) to reduce the tie-break.
+			template<class P, class U, class V>
+			bool is_locally_pd_delaunay_edge(const P& a,const P& b,const P& c,const P& d,const U& u,const V& v)const{
+				++(stat_.locally_pd_delaunay_edge_total_count);
+				if(are_bounded_integers(side_of_oriented_circle_integer_bits,{a.x(),a.y(),b.x(),b.y(),c.x(),c.y(),d.x(),d.y()})){
+					Quad_differences<wide_int> q = make_quad_differences<wide_int>(a,b,c,d);
+					int side = side_of_oriented_circle_sign(q);
+					if(side != 0){
+						++(stat_.locally_pd_delaunay_edge_integer_count);
+						return (side < 0);
+					}
+					if(are_bounded_integers(preferred_direction_integer_bits,{a.x(),a.y(),b.x(),b.y(),c.x(),c.y(),d.x(),d.y(),u.x(),u.y(),v.x(),v.y()})){
+						++(stat_.locally_pd_delaunay_edge_integer_count);
+						++(stat_.locally_pd_delaunay_edge_tie_count);
+						return pd_tie_break(q,u,v);
+					}
+				}
+				bool tie;
+				bool result;
+				if(use_filter(Filter::locally_pd_delaunay_edge,stat_.locally_pd_delaunay_edge_filter_skip_count)){
+					try{
+						result = is_locally_pd_delaunay_quad(make_quad_differences<itv>(a,b,c,d),u,v,tie);
+						record_filter(Filter::locally_pd_delaunay_edge,false,stat_.locally_pd_delaunay_edge_filter_switch_count);
+						if(tie){ ++(stat_.locally_pd_delaunay_edge_tie_count); }
+						return result;
+					}
+					catch(const idr& e){
+						record_filter(Filter::locally_pd_delaunay_edge,true,stat_.locally_pd_delaunay_edge_filter_switch_count);
+					}
+				}
+				++(stat_.locally_pd_delaunay_edge_exact_count);
+				RA_ALLOC_SCOPE(ra::profile::Region::locally_pd_delaunay_edge_exact);
+				if(are_expansion_safe({a.x(),a.y(),b.x(),b.y(),c.x(),c.y(),d.x(),d.y(),u.x(),u.y(),v.x(),v.y()})){
+					xpn_scope scope(locally_pd_delaunay_edge_capacity(u,v));
+					result = is_locally_pd_delaunay_quad(make_quad_differences<xpn>(a,b,c,d),u,v,tie);
+					stat_.locally_pd_delaunay_edge_exact_allocation_count += scope.heap_allocation_count();
+				}
 				else{
-					if((preferred_direction(a,c,b,d,u)) > 0) { return true; }
-					else if( ((preferred_direction(a,c,b,d,u))==0) && ((preferred_direction(a,c,b,d,v))>0) ){
-						return true;
+					result = is_locally_pd_delaunay_quad(make_quad_differences<exct>(a,b,c,d),u,v,tie);
+				}
+				if(tie){ ++(stat_.locally_pd_delaunay_edge_tie_count); }
+				return result;
+			}
+			template<class P, int UX, int UY, int VX, int VY>
+			bool is_locally_pd_delaunay_edge(const P& a,const P& b,const P& c,const P& d,Pd_directions<UX,UY,VX,VY> directions)const{
+				return is_locally_pd_delaunay_edge(a,b,c,d,directions.u,directions.v);
+			}
+
+			// Tests if the edge with endpoints a and c and two incident
+			// faces abc and acd is flippable (i.e., if the quadrilateral
+			// abcd is strictly convex). Since the faces are CCW, only the
+			// two orientation tests across the diagonal ac are performed.
+			// Precondition: The points a, b, c, and d have distinct values;
+			// the triangles abc and acd are CCW.
+			template<class P>
+			bool is_flippable_quad(const P& a,const P& b,const P& c,const P& d) const {
+				++(stat_.flippable_quad_total_count);
+				if(are_bounded_integers(orientation_integer_bits,{a.x(),a.y(),b.x(),b.y(),c.x(),c.y(),d.x(),d.y()})){
+					++(stat_.flippable_quad_integer_count);
+					return is_convex_across_diagonal(make_quad_differences<wide_int>(a,b,c,d));
+				}
+				if(use_filter(Filter::flippable_quad,stat_.flippable_quad_filter_skip_count)){
+					try{
+						bool result = is_convex_across_diagonal(make_quad_differences<itv>(a,b,c,d));
+						record_filter(Filter::flippable_quad,false,stat_.flippable_quad_filter_switch_count);
+						return result;
+					}
+					catch(const idr& e){
+						record_filter(Filter::flippable_quad,true,stat_.flippable_quad_filter_switch_count);
+					}
+				}
+				++(stat_.flippable_quad_exact_count);
+				RA_ALLOC_SCOPE(ra::profile::Region::flippable_quad_exact);
+				if(are_expansion_safe({a.x(),a.y(),b.x(),b.y(),c.x(),c.y(),d.x(),d.y()})){
+					xpn_scope scope(flippable_quad_capacity());
+					bool result = is_convex_across_diagonal(make_quad_differences<xpn>(a,b,c,d));
+					stat_.flippable_quad_exact_allocation_count += scope.heap_allocation_count();
+					return result;
+				}
+				return is_convex_across_diagonal(make_quad_differences<exct>(a,b,c,d));
+			}
+
+			// Tests if the edge with endpoints a and c and two incident
+			// faces abc and acd must be flipped by the LOP (i.e., if it is
+			// flippable and does not have the preferred-directions
+			// locally-Delaunay property with respect to u and v).
+			// This combines is_flippable_quad and is_locally_pd_delaunay_edge,
+			// sharing the coordinate differences between all of the tests.
+			// Precondition: The points a, b, c, and d have distinct values;
+			// the triangles abc and acd are CCW; the vectors u and v are not
+			// zero vectors; the vectors u and v are neither parallel nor
+			// orthogonal.
+			template<class P, class U, class V>
+			bool needs_pd_flip(const P& a,const P& b,const P& c,const P& d,const U& u,const V& v)const{
+				++(stat_.flippable_quad_total_count);
+				if(are_bounded_integers(side_of_oriented_circle_integer_bits,{a.x(),a.y(),b.x(),b.y(),c.x(),c.y(),d.x(),d.y()})){
+					Quad_differences<wide_int> q = make_quad_differences<wide_int>(a,b,c,d);
+					++(stat_.flippable_quad_integer_count);
+					if(!is_convex_across_diagonal(q)){ return false; }
+					int side = side_of_oriented_circle_sign(q);
+					if(side != 0){
+						++(stat_.locally_pd_delaunay_edge_total_count);
+						++(stat_.locally_pd_delaunay_edge_integer_count);
+						return (side > 0);
+					}
+					if(are_bounded_integers(preferred_direction_integer_bits,{a.x(),a.y(),b.x(),b.y(),c.x(),c.y(),d.x(),d.y(),u.x(),u.y(),v.x(),v.y()})){
+						++(stat_.locally_pd_delaunay_edge_total_count);
+						++(stat_.locally_pd_delaunay_edge_integer_count);
+						++(stat_.locally_pd_delaunay_edge_tie_count);
+						return !pd_tie_break(q,u,v);
+					}
+					return !is_locally_pd_delaunay_edge(a,b,c,d,u,v);
+				}
+				bool convex_known = false;
+				if(use_filter(Filter::needs_pd_flip,stat_.flippable_quad_filter_skip_count)){
+					try{
+						Quad_differences<itv> q = make_quad_differences<itv>(a,b,c,d);
+						bool result = false;
+						if(is_convex_across_diagonal(q)){
+							convex_known = true;
+							++(stat_.locally_pd_delaunay_edge_total_count);
+							bool tie;
+							result = !is_locally_pd_delaunay_quad(q,u,v,tie);
+							if(tie){ ++(stat_.locally_pd_delaunay_edge_tie_count); }
+						}
+						record_filter(Filter::needs_pd_flip,false,stat_.flippable_quad_filter_switch_count);
+						return result;
+					}
+					catch(const idr& e){
+						record_filter(Filter::needs_pd_flip,true,stat_.flippable_quad_filter_switch_count);
+					}
+				}
+				RA_ALLOC_SCOPE(convex_known ? ra::profile::Region::locally_pd_delaunay_edge_exact : ra::profile::Region::flippable_quad_exact);
+				if(are_expansion_safe({a.x(),a.y(),b.x(),b.y(),c.x(),c.y(),d.x(),d.y(),u.x(),u.y(),v.x(),v.y()})){
+					xpn_scope scope(flippable_quad_capacity() + locally_pd_delaunay_edge_capacity(u,v));
+					bool result = needs_pd_flip_quad(make_quad_differences<xpn>(a,b,c,d),u,v,convex_known);
+					if(convex_known){ stat_.locally_pd_delaunay_edge_exact_allocation_count += scope.heap_allocation_count(); }
+					else{ stat_.flippable_quad_exact_allocation_count += scope.heap_allocation_count(); }
+					return result;
+				}
+				return needs_pd_flip_quad(make_quad_differences<exct>(a,b,c,d),u,v,convex_known);
+			}
+			template<class P, int UX, int UY, int VX, int VY>
+			bool needs_pd_flip(const P& a,const P& b,const P& c,const P& d,Pd_directions<UX,UY,VX,VY> directions)const{
+				return needs_pd_flip(a,b,c,d,directions.u,directions.v);
+			}
+
+			// As above for cached points, trying the semi-static filter on
+			// their cached values first (which decides every test but those
+			// of nearly degenerate quadrilaterals, including those decided
+			// by the tie-break).
+			template<class U, class V>
+			bool needs_pd_flip(const Cached_point& a,const Cached_point& b,const Cached_point& c,const Cached_point& d,const U& u,const V& v)const{
+				if(a.filter_safe && b.filter_safe && c.filter_safe && d.filter_safe){
+					int across = semi_static_orientation_sign(b,c,d);
+					if(across == 1){ across = semi_static_orientation_sign(a,b,d); }
+					if(across == -1){
+						++(stat_.flippable_quad_total_count);
+						++(stat_.flippable_quad_semi_static_count);
+						return false;
+					}
+					if(across == 1){
+						int side = semi_static_side_of_oriented_circle_sign(a,b,c,d);
+						if(side != 2){
+							++(stat_.flippable_quad_total_count);
+							++(stat_.flippable_quad_semi_static_count);
+							++(stat_.locally_pd_delaunay_edge_total_count);
+							return (side > 0);
+						}
 					}
-					else{ return false;}
 				}
+				return needs_pd_flip<Cached_point>(a,b,c,d,u,v);
+			}
+
+			// Member function to evaluate needs_pd_flip exactly from the
+			// coordinate differences of a quadrilateral. If convex_known is
+			// set, the quadrilateral is already known to be strictly convex.
+			template<class NT, class U, class V>
+			static bool needs_pd_flip_quad(const Quad_differences<NT>& q, const U& u, const V& v, bool convex_known) {
+				if(!convex_known){
+					++(stat_.flippable_quad_exact_count);
+					if(!is_convex_across_diagonal(q)){ return false; }
+					++(stat_.locally_pd_delaunay_edge_total_count);
+				}
+				++(stat_.locally_pd_delaunay_edge_exact_count);
+				bool tie;
+				bool result = is_locally_pd_delaunay_quad(q,u,v,tie);
+				if(tie){ ++(stat_.locally_pd_delaunay_edge_tie_count); }
+				return !result;
 			}
 
 			// Clear (i.e., set to zero) all kernel statistics.
 			static void clear_statistics(){
 				stat_.orientation_total_count=0;
 				stat_.orientation_exact_count=0;
+				stat_.orientation_exact_allocation_count=0;
+				stat_.orientation_integer_count=0;
+				stat_.orientation_filter_skip_count=0;
+				stat_.orientation_filter_switch_count=0;
 				stat_.preferred_direction_total_count=0;
 				stat_.preferred_direction_exact_count=0;
+				stat_.preferred_direction_exact_allocation_count=0;
+				stat_.preferred_direction_integer_count=0;
+				stat_.preferred_direction_filter_skip_count=0;
+				stat_.preferred_direction_filter_switch_count=0;
 				stat_.side_of_oriented_circle_total_count=0;
 				stat_.side_of_oriented_circle_exact_count=0;
+				stat_.side_of_oriented_circle_exact_allocation_count=0;
+				stat_.side_of_oriented_circle_integer_count=0;
+				stat_.side_of_oriented_circle_filter_skip_count=0;
+				stat_.side_of_oriented_circle_filter_switch_count=0;
+				stat_.side_of_oriented_circle_semi_static_count=0;
+				stat_.locally_pd_delaunay_edge_total_count=0;
+				stat_.locally_pd_delaunay_edge_exact_count=0;
+				stat_.locally_pd_delaunay_edge_exact_allocation_count=0;
+				stat_.locally_pd_delaunay_edge_integer_count=0;
+				stat_.locally_pd_delaunay_edge_filter_skip_count=0;
+				stat_.locally_pd_delaunay_edge_filter_switch_count=0;
+				stat_.locally_pd_delaunay_edge_tie_count=0;
+				stat_.flippable_quad_total_count=0;
+				stat_.flippable_quad_exact_count=0;
+				stat_.flippable_quad_exact_allocation_count=0;
+				stat_.flippable_quad_integer_count=0;
+				stat_.flippable_quad_filter_skip_count=0;
+				stat_.flippable_quad_filter_switch_count=0;
+				stat_.flippable_quad_semi_static_count=0;
 			}
 
 			// Get the current values of the kernel statistics.
@@ -244,24 +971,139 @@ namespace ra::geometry {
 				statistics = stat_;
 			}
 
+			// Add statistics (e.g., those of another thread) to the kernel
+			// statistics of the calling thread.
+			static void add_statistics(const Statistics& statistics){
+				stat_.orientation_total_count += statistics.orientation_total_count;
+				stat_.orientation_exact_count += statistics.orientation_exact_count;
+				stat_.orientation_exact_allocation_count += statistics.orientation_exact_allocation_count;
+				stat_.orientation_integer_count += statistics.orientation_integer_count;
+				stat_.orientation_filter_skip_count += statistics.orientation_filter_skip_count;
+				stat_.orientation_filter_switch_count += statistics.orientation_filter_switch_count;
+				stat_.preferred_direction_total_count += statistics.preferred_direction_total_count;
+				stat_.preferred_direction_exact_count += statistics.preferred_direction_exact_count;
+				stat_.preferred_direction_exact_allocation_count += statistics.preferred_direction_exact_allocation_count;
+				stat_.preferred_direction_integer_count += statistics.preferred_direction_integer_count;
+				stat_.preferred_direction_filter_skip_count += statistics.preferred_direction_filter_skip_count;
+				stat_.preferred_direction_filter_switch_count += statistics.preferred_direction_filter_switch_count;
+				stat_.side_of_oriented_circle_total_count += statistics.side_of_oriented_circle_total_count;
+				stat_.side_of_oriented_circle_exact_count += statistics.side_of_oriented_circle_exact_count;
+				stat_.side_of_oriented_circle_exact_allocation_count += statistics.side_of_oriented_circle_exact_allocation_count;
+				stat_.side_of_oriented_circle_integer_count += statistics.side_of_oriented_circle_integer_count;
+				stat_.side_of_oriented_circle_filter_skip_count += statistics.side_of_oriented_circle_filter_skip_count;
+				stat_.side_of_oriented_circle_filter_switch_count += statistics.side_of_oriented_circle_filter_switch_count;
+				stat_.side_of_oriented_circle_semi_static_count += statistics.side_of_oriented_circle_semi_static_count;
+				stat_.locally_pd_delaunay_edge_total_count += statistics.locally_pd_delaunay_edge_total_count;
+				stat_.locally_pd_delaunay_edge_exact_count += statistics.locally_pd_delaunay_edge_exact_count;
+				stat_.locally_pd_delaunay_edge_exact_allocation_count += statistics.locally_pd_delaunay_edge_exact_allocation_count;
+				stat_.locally_pd_delaunay_edge_integer_count += statistics.locally_pd_delaunay_edge_integer_count;
+				stat_.locally_pd_delaunay_edge_filter_skip_count += statistics.locally_pd_delaunay_edge_filter_skip_count;
+				stat_.locally_pd_delaunay_edge_filter_switch_count += statistics.locally_pd_delaunay_edge_filter_switch_count;
+				stat_.locally_pd_delaunay_edge_tie_count += statistics.locally_pd_delaunay_edge_tie_count;
+				stat_.flippable_quad_total_count += statistics.flippable_quad_total_count;
+				stat_.flippable_quad_exact_count += statistics.flippable_quad_exact_count;
+				stat_.flippable_quad_exact_allocation_count += statistics.flippable_quad_exact_allocation_count;
+				stat_.flippable_quad_integer_count += statistics.flippable_quad_integer_count;
+				stat_.flippable_quad_filter_skip_count += statistics.flippable_quad_filter_skip_count;
+				stat_.flippable_quad_filter_switch_count += statistics.flippable_quad_filter_switch_count;
+				stat_.flippable_quad_semi_static_count += statistics.flippable_quad_semi_static_count;
+			}
+
 			static Statistics make_stat(){
 				Statistics temp;
 				temp.orientation_total_count = 0;
 				temp.orientation_exact_count = 0;
+				temp.orientation_exact_allocation_count = 0;
+				temp.orientation_integer_count = 0;
+				temp.orientation_filter_skip_count = 0;
+				temp.orientation_filter_switch_count = 0;
 				temp.preferred_direction_total_count = 0;
 				temp.preferred_direction_exact_count = 0;
+				temp.preferred_direction_exact_allocation_count = 0;
+				temp.preferred_direction_integer_count = 0;
+				temp.preferred_direction_filter_skip_count = 0;
+				temp.preferred_direction_filter_switch_count = 0;
 				temp.side_of_oriented_circle_total_count = 0;
 				temp.side_of_oriented_circle_exact_count = 0;
+				temp.side_of_oriented_circle_exact_allocation_count = 0;
+				temp.side_of_oriented_circle_integer_count = 0;
+				temp.side_of_oriented_circle_filter_skip_count = 0;
+				temp.side_of_oriented_circle_filter_switch_count = 0;
+				temp.side_of_oriented_circle_semi_static_count = 0;
+				temp.locally_pd_delaunay_edge_total_count = 0;
+				temp.locally_pd_delaunay_edge_exact_count = 0;
+				temp.locally_pd_delaunay_edge_exact_allocation_count = 0;
+				temp.locally_pd_delaunay_edge_integer_count = 0;
+				temp.locally_pd_delaunay_edge_filter_skip_count = 0;
+				temp.locally_pd_delaunay_edge_filter_switch_count = 0;
+				temp.locally_pd_delaunay_edge_tie_count = 0;
+				temp.flippable_quad_total_count = 0;
+				temp.flippable_quad_exact_count = 0;
+				temp.flippable_quad_exact_allocation_count = 0;
+				temp.flippable_quad_integer_count = 0;
+				temp.flippable_quad_filter_skip_count = 0;
+				temp.flippable_quad_filter_switch_count = 0;
+				temp.flippable_quad_semi_static_count = 0;
 				return temp;
 			}
 
 		private:
-			static Statistics stat_;
+			// The state of the adaptive selection of the interval filter of a test.
+			struct Filter_state {
+				// The outcomes of the last filter_window filter attempts, one bit each (set for a failure)
+				std::uint64_t window;
+				// The number of outcomes in the window
+				int count;
+				// Whether the filter is skipped
+				bool skipping;
+				// The number of tests since the last probe of a skipped filter
+				int since_probe;
+			};
+
+			// Member function to decide if the interval filter of a test is
+			// attempted. A skipped filter is probed once every
+			// filter_probe_interval tests, so that a change in the data is seen.
+			static bool use_filter(Filter test, std::size_t& skip_count) {
+				Filter_state& state = filter_[static_cast<int>(test)];
+				if(!(state.skipping)){ return true; }
+				if(++(state.since_probe) >= filter_probe_interval){
+					state.since_probe = 0;
+					return true;
+				}
+				++skip_count;
+				return false;
+			}
+
+			// Member function to record the outcome of an attempt of the
+			// interval filter of a test and switch the filter off or on.
+			static void record_filter(Filter test, bool failed, std::size_t& switch_count) {
+				static_assert(filter_window == std::numeric_limits<std::uint64_t>::digits);
+				Filter_state& state = filter_[static_cast<int>(test)];
+				state.window = (state.window << 1) | std::uint64_t(failed);
+				if(state.count < filter_window){ ++(state.count); }
+				if(state.count < filter_window){ return; }
+				int failures = static_cast<int>(std::bitset<filter_window>(state.window).count());
+				if( !(state.skipping) && (failures >= filter_skip_failures) ){
+					state.skipping = true;
+					state.since_probe = 0;
+					++switch_count;
+				}
+				else if( state.skipping && (failures <= filter_resume_failures) ){
+					state.skipping = false;
+					++switch_count;
+				}
+			}
+
+			static thread_local Statistics stat_;
+			static thread_local Filter_state filter_[filter_count];
 
 	};
 
 	template<class Real>
-	typename Kernel<Real>::Statistics Kernel<Real>::stat_ = Kernel<Real>::make_stat();
+	thread_local typename Kernel<Real>::Statistics Kernel<Real>::stat_ = Kernel<Real>::make_stat();
+
+	template<class Real>
+	thread_local typename Kernel<Real>::Filter_state Kernel<Real>::filter_[Kernel<Real>::filter_count] = {};
 	
 }
 #endif
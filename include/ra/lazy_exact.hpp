@@ -0,0 +1,188 @@
+#ifndef LAZY_EXACT_HPP
+#define LAZY_EXACT_HPP
+#include<memory>
+#include<optional>
+#include<iostream>
+#include"ra/interval.hpp"
+namespace ra::math {
+
+	// A lazily-evaluated exact number.
+	// Each value is a node in a DAG of arithmetic operations that carries
+	// an interval approximation of its value. The exact value of a node
+	// (of type ET) is only computed when the sign of an approximation is
+	// indeterminate, and it is cached on the node, so that nodes shared
+	// between expressions (e.g., lifted coordinates of a point) are only
+	// evaluated exactly once. Nodes whose approximation is a singleton
+	// are exact already. The sign is refined from the root down: a
+	// subexpression whose approximation already has a sign is not
+	// evaluated unless its value is needed (e.g., the sign of a product
+	// only needs the signs of its factors, and the sign of a sum of terms
+	// of the same sign only needs that sign), so only the subexpressions
+	// contributing to the uncertainty are evaluated exactly.
+	// Shared nodes are not safe for concurrent use by multiple threads.
+	template<class T, class ET>
+	class lazy_exact{
+		public:
+			using real_type = T;
+			using exact_type = ET;
+			using approx_type = interval<T>;
+
+			struct statistics{
+				// The total number of signs requiring exact evaluation.
+				unsigned long exact_sign_count;
+				// The total number of nodes evaluated exactly.
+				unsigned long exact_node_count;
+			};
+
+			lazy_exact(real_type value = real_type(0)) : node_(std::make_shared<node>(approx_type(value))) {}
+
+			const approx_type& approx() const { return node_->approx; }
+
+			// Get the exact value, evaluating and caching it if needed.
+			const exact_type& exact() const { return evaluate(*node_); }
+
+			// Get the sign of the value, refining the approximation if
+			// it is indeterminate.
+			int sign() const {
+				try{
+					return node_->approx.sign();
+				}
+				catch(const indeterminate_result& e){
+					return exact_sign();
+				}
+			}
+
+			// Get the sign of the exact value.
+			int exact_sign() const {
+				++(stat_.exact_sign_count);
+				return refine_sign(*node_);
+			}
+
+			static lazy_exact add(const lazy_exact& obj_A, const lazy_exact& obj_B){
+				return lazy_exact(operation::add, obj_A.node_->approx + obj_B.node_->approx, obj_A, obj_B);
+			}
+			static lazy_exact subtract(const lazy_exact& obj_A, const lazy_exact& obj_B){
+				return lazy_exact(operation::subtract, obj_A.node_->approx - obj_B.node_->approx, obj_A, obj_B);
+			}
+			static lazy_exact multiply(const lazy_exact& obj_A, const lazy_exact& obj_B){
+				return lazy_exact(operation::multiply, obj_A.node_->approx * obj_B.node_->approx, obj_A, obj_B);
+			}
+
+			static void clear_statistics() {
+				stat_.exact_sign_count = 0;
+				stat_.exact_node_count = 0;
+			}
+
+			static void get_statistics(statistics& stat) {
+				stat = stat_;
+			}
+
+			static statistics make_stat(){
+				statistics temp;
+				temp.exact_sign_count = 0;
+				temp.exact_node_count = 0;
+				return temp;
+			}
+
+		private:
+			enum class operation { leaf, add, subtract, multiply };
+
+			struct node{
+				node(const approx_type& set_approx) : approx(set_approx), op(operation::leaf) {}
+				node(operation set_op, const approx_type& set_approx, std::shared_ptr<const node> set_left, std::shared_ptr<const node> set_right) :
+				  approx(set_approx), op(set_op), left(std::move(set_left)), right(std::move(set_right)) {}
+				approx_type approx;
+				operation op;
+				std::shared_ptr<const node> left;
+				std::shared_ptr<const node> right;
+				mutable std::optional<exact_type> exact;
+			};
+
+			lazy_exact(operation op, const approx_type& approx, const lazy_exact& obj_A, const lazy_exact& obj_B) :
+			  node_(std::make_shared<node>(op, approx, obj_A.node_, obj_B.node_)) {}
+
+			// Gets the sign of the approximation a in sgn, if it is known.
+			static bool approx_sign(const approx_type& a, int& sgn){
+				if(a.lower() > real_type(0)){ sgn = 1; }
+				else if(a.upper() < real_type(0)){ sgn = -1; }
+				else if( (a.lower() == real_type(0)) && (a.upper() == real_type(0)) ){ sgn = 0; }
+				else{ return false; }
+				return true;
+			}
+
+			static int exact_value_sign(const exact_type& e){
+				if(e < exact_type(0)){ return -1; }
+				else if(e > exact_type(0)){ return 1; }
+				else{ return 0; }
+			}
+
+			// Gets the sign of the value of the node, from its approximation
+			// or cached exact value if possible, then from the signs of its
+			// operands, and only then by evaluating it exactly.
+			static int refine_sign(const node& n){
+				int sgn;
+				if(approx_sign(n.approx, sgn)){ return sgn; }
+				if(n.exact){ return exact_value_sign(*(n.exact)); }
+				if(n.op == operation::multiply){
+					int left = refine_sign(*(n.left));
+					return (left == 0) ? 0 : left * refine_sign(*(n.right));
+				}
+				// The sign of a sum is that of its operands if they agree
+				// (or if one of them is zero).
+				int left = refine_sign(*(n.left));
+				int right = refine_sign(*(n.right));
+				if(n.op == operation::subtract){ right = -right; }
+				if(left == 0){ return right; }
+				if( (right == 0) || (left == right) ){ return left; }
+				return exact_value_sign(evaluate(n));
+			}
+
+			static const exact_type& evaluate(const node& n){
+				if(!(n.exact)){
+					++(stat_.exact_node_count);
+					if(n.approx.is_singleton()){
+						n.exact = exact_type(n.approx.lower());
+					}
+					else if(n.op == operation::add){
+						n.exact = evaluate(*(n.left)) + evaluate(*(n.right));
+					}
+					else if(n.op == operation::subtract){
+						n.exact = evaluate(*(n.left)) - evaluate(*(n.right));
+					}
+					else{
+						n.exact = evaluate(*(n.left)) * evaluate(*(n.right));
+					}
+				}
+				return *(n.exact);
+			}
+
+			std::shared_ptr<node> node_;
+			static thread_local statistics stat_;
+	};
+
+	template<class T, class ET>
+	thread_local typename lazy_exact<T,ET>::statistics lazy_exact<T,ET>::stat_ = lazy_exact<T,ET>::make_stat();
+
+	template<class T, class ET>
+	lazy_exact<T,ET> operator+(const lazy_exact<T,ET>& obj_A, const lazy_exact<T,ET>& obj_B){
+		return lazy_exact<T,ET>::add(obj_A, obj_B);
+	}
+
+	template<class T, class ET>
+	lazy_exact<T,ET> operator-(const lazy_exact<T,ET>& obj_A, const lazy_exact<T,ET>& obj_B){
+		return lazy_exact<T,ET>::subtract(obj_A, obj_B);
+	}
+
+	template<class T, class ET>
+	lazy_exact<T,ET> operator*(const lazy_exact<T,ET>& obj_A, const lazy_exact<T,ET>& obj_B){
+		return lazy_exact<T,ET>::multiply(obj_A, obj_B);
+	}
+
+	template<class T, class ET>
+	std::ostream& operator<<(std::ostream& outStream, const lazy_exact<T,ET>& obj){
+		outStream<<(obj.approx());
+		return outStream;
+	}
+
+}
+#endif
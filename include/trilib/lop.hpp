@@ -0,0 +1,174 @@
+#ifndef TRILIB_LOP_HPP
+#define TRILIB_LOP_HPP
+#include<cstddef>
+#include<cstdint>
+#include<functional>
+
+// The library interface of the preferred-directions Delaunay LOP.
+// A triangulation is passed as arrays owned by the caller, and the result
+// is written to an array owned by the caller, so no text is formatted and
+// no data is copied other than into the triangulation itself. This header
+// does not depend on CGAL, and the library (trilib_lop) is built both as a
+// static and as a shared library.
+namespace trilib {
+
+	// A view of a contiguous array owned by the caller.
+	template<class T>
+	class span {
+		public:
+			constexpr span() : data_(nullptr), size_(0) {}
+			constexpr span(T* data, std::size_t size) : data_(data), size_(size) {}
+			// A view of a container with contiguous storage (e.g., a vector).
+			template<class Container>
+			span(Container& c) : data_(c.data()), size_(c.size()) {}
+			constexpr T* data() const { return data_; }
+			constexpr std::size_t size() const { return size_; }
+			constexpr T& operator[](std::size_t i) const { return data_[i]; }
+			constexpr T* begin() const { return data_; }
+			constexpr T* end() const { return data_ + size_; }
+		private:
+			T* data_;
+			std::size_t size_;
+	};
+
+	// The order in which the LOP processes the suspect edges.
+	enum class Schedule {
+		// The most recently pushed edge first.
+		lifo,
+		// The least recently pushed edge first.
+		fifo,
+		// As lifo, but with the initial suspect edges sorted along a Hilbert
+		// curve through their midpoints, for locality of reference. Only
+		// this seed order is spatial: the edges pushed by a flip are taken
+		// last in, first out, as with lifo (they are the sides of the
+		// flipped quadrilateral, so they are near the edge being processed).
+		spatial,
+		// The edge whose quadrilateral most violates the incircle test
+		// first, as estimated with floating-point arithmetic and scaled to
+		// be independent of the size of the quadrilateral.
+		priority,
+	};
+
+	// The levels of validation of an input triangulation. The levels below
+	// full skip the geometric checks: the faces must then be CCW and the
+	// border convex, or the result of the LOP is meaningless.
+	enum class Validation {
+		// Check the topology, the orientation of every face and the
+		// convexity of the border.
+		full,
+		// Only check the topology.
+		topology,
+		// Only check what is needed to build the triangulation (for data
+		// produced by our own tools).
+		trusted,
+	};
+
+	// The progress of a run of the LOP, as reported to a progress callback.
+	struct Lop_progress {
+		// The number of edge flips performed so far.
+		std::size_t flip_count;
+		// The number of suspect edges tested so far.
+		std::size_t test_count;
+		// The number of edges left on the suspect list.
+		std::size_t remaining_count;
+		// The time since the start of the run, in seconds.
+		double seconds;
+	};
+
+	// The budget of a run of the LOP. A run that exhausts its budget stops
+	// between two flips, so the triangulation is always valid (but not yet
+	// preferred-directions Delaunay), and the edges left on the suspect
+	// list are kept so that the run can be resumed.
+	struct Lop_budget {
+		// The maximum number of flips (zero for no limit).
+		std::size_t max_flips = 0;
+		// The maximum time, in seconds (zero for no limit), counted from
+		// the start of the run (including the collection of the suspect
+		// edges, but not the building of the triangulation). Since the
+		// time is only checked every progress_interval tested edges, the
+		// run may exceed it by the time of that many tests.
+		double max_seconds = 0.0;
+		// Called with the progress of the run before the first test and
+		// then every progress_interval tested edges (if not empty). The
+		// run stops if it returns false.
+		std::function<bool(const Lop_progress&)> progress;
+		// The number of tested edges between two checks of the time and
+		// calls of progress.
+		std::size_t progress_interval = 4096;
+	};
+
+	// The options of a run of the LOP.
+	struct Lop_options {
+		// The first preferred direction.
+		double u[2] = {1.0, 0.0};
+		// The second preferred direction.
+		double v[2] = {1.0, 1.0};
+		// The order in which the LOP processes the suspect edges.
+		Schedule schedule = Schedule::lifo;
+		// The level of validation of the input triangulation.
+		Validation validation = Validation::full;
+		// Store the triangulation along a Hilbert curve while building it
+		// (off by default, since its gain has not been measured with a
+		// CGAL build; see Triangulation_2::set_spatial_sort).
+		bool spatial_sort = false;
+		// The budget of the run (unlimited by default).
+		Lop_budget budget;
+		// Start from the edges of resume_edges (e.g., the remaining edges
+		// of a run that exhausted its budget) instead of from every
+		// flippable edge.
+		bool resume = false;
+		// The two vertex indices of each edge to resume from.
+		span<const std::int32_t> resume_edges;
+	};
+
+	// The result and statistics of a run of the LOP.
+	struct Lop_result {
+		// Whether the input was a valid triangulation and the result was written.
+		bool ok;
+		// Whether the LOP ran to completion (i.e., the result is
+		// preferred-directions Delaunay) instead of exhausting its budget.
+		bool complete;
+		// The number of distinct edges left on the suspect list.
+		std::size_t remaining_count;
+		// The number of edge flips performed.
+		std::size_t flip_count;
+		// The number of edges pushed onto the suspect list.
+		std::size_t suspect_push_count;
+		// The number of suspect edges tested.
+		std::size_t test_count;
+		// The number of flippable-quadrilateral tests (and those requiring exact arithmetic).
+		std::size_t flippable_quad_total_count;
+		std::size_t flippable_quad_exact_count;
+		// The number of preferred-directions locally-Delaunay edge tests (and those requiring exact arithmetic).
+		std::size_t locally_pd_delaunay_edge_total_count;
+		std::size_t locally_pd_delaunay_edge_exact_count;
+		// The number of preferred-directions locally-Delaunay edge tests decided by the tie-break.
+		std::size_t locally_pd_delaunay_edge_tie_count;
+		// The time spent building the triangulation, in seconds.
+		double build_seconds;
+		// The time spent by the LOP, in seconds.
+		double lop_seconds;
+	};
+
+	// Transforms a triangulation into the preferred-directions Delaunay
+	// triangulation with respect to the directions of options.
+	// The array coordinates holds the x and y coordinates of each vertex,
+	// and the array faces holds the three vertex indices of each face (in
+	// CCW order). The faces of the result are written to result_faces in
+	// the same form; it must have the size of faces (since the LOP does not
+	// change the number of faces), and it may be the same array as faces.
+	// If the input is invalid (in which case ok is false in the result),
+	// result_faces is unchanged. Invalid topology (e.g., repeated or
+	// non-manifold faces, or no faces) is detected at every level of
+	// validation, but the geometry (e.g., faces in CW order) only at full.
+	// If the run exhausts its budget, the two vertex indices of each edge
+	// left on the suspect list are written to remaining_edges (if not
+	// empty), from which the run can be resumed. It must then hold two
+	// values per edge of the triangulation (i.e., 2 * (V + F - 1) values
+	// for a triangulation of a disk with V vertices and F faces).
+	Lop_result pd_delaunay_triangulate(span<const double> coordinates, span<const std::int32_t> faces,
+	  span<std::int32_t> result_faces, const Lop_options& options = Lop_options(),
+	  span<std::int32_t> remaining_edges = span<std::int32_t>());
+
+}
+#endif